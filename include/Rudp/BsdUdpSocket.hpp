@@ -1,20 +1,67 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <span>
+#include <string_view>
 #include <vector>
 
 #include "Rudp/ServerSessionManager.hpp"
 
 namespace Rudp::Runtime {
 
-struct ReceivedDatagram final {
+// Upper bound on datagrams moved per batched socket call. Batch arrays of
+// this size live on the stack inside recv_batch().
+constexpr std::size_t kMaxDatagramBatch = 64;
+
+// Largest UDP payload the kernel may hand back when GRO coalesces several
+// datagrams into one receive slot.
+constexpr std::size_t kMaxGroBufferSize = 65535;
+
+// One caller-owned receive slot. `buffer` is allocated once up front and
+// reused for every batch; `size` is the length of the last datagram written
+// into it. With GRO enabled the slot may hold several datagrams from the same
+// sender back to back; `segment_size` is then the length of each one (the
+// last may be shorter) and 0 means the slot holds a single datagram.
+struct ReceiveSlot final {
   Session::EndpointKey endpoint;
-  std::vector<std::byte> bytes;
+  std::vector<std::byte> buffer;
+  std::size_t size = 0;
+  std::size_t segment_size = 0;
+
+  [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+    return std::span<const std::byte>(buffer.data(), size);
+  }
 };
 
+// Resolves a host name or numeric address to an IPv4 endpoint. Intended for
+// startup configuration, not the packet path.
+[[nodiscard]] std::optional<Session::EndpointKey> resolve_endpoint(
+    std::string_view address,
+    std::uint16_t port);
+
+[[nodiscard]] std::vector<ReceiveSlot> make_receive_slots(
+    std::size_t slot_count,
+    std::size_t buffer_size);
+
+// Invokes `fn(bytes)` once per datagram held in `slot`, splitting GRO
+// coalesced payloads back into their original datagrams.
+template <typename Fn>
+void for_each_datagram(const ReceiveSlot& slot, Fn&& fn) {
+  const auto bytes = slot.bytes();
+  if (slot.segment_size == 0 || slot.segment_size >= bytes.size()) {
+    fn(bytes);
+    return;
+  }
+  for (std::size_t offset = 0; offset < bytes.size();
+       offset += slot.segment_size) {
+    fn(bytes.subspan(offset,
+                     std::min(slot.segment_size, bytes.size() - offset)));
+  }
+}
+
 class BsdUdpSocket final {
  public:
   BsdUdpSocket() = default;
@@ -28,11 +75,43 @@ class BsdUdpSocket final {
 
   [[nodiscard]] static std::optional<BsdUdpSocket> create_non_blocking();
 
+  // Lets several sockets bind the same address and port (SO_REUSEPORT). The
+  // kernel then hashes each flow's 4-tuple to one of them. Call before bind().
+  [[nodiscard]] bool enable_reuse_port();
   [[nodiscard]] bool bind(std::string_view address, std::uint16_t port);
+  // Replaces the 4-tuple hash of this socket's SO_REUSEPORT group with a
+  // classic BPF program that routes each datagram to socket
+  // `conn_id % shard_count`, in bind order. Datagrams with ConnId 0 (new
+  // handshakes) keep the hash. Call once, after every socket of the group is
+  // bound. Returns false where the option is unavailable.
+  bool steer_by_conn_id(std::uint32_t shard_count);
+  // Port the socket is bound to; resolves an ephemeral port 0 after bind().
+  [[nodiscard]] std::optional<std::uint16_t> local_port() const;
   [[nodiscard]] bool send_to(const Session::EndpointKey& endpoint,
                              std::span<const std::byte> bytes) const;
-  [[nodiscard]] std::optional<ReceivedDatagram> recv_from(
-      std::size_t buffer_size) const;
+  // Sends the datagrams of `batch` from index `first` on, in order, using as
+  // few sendmmsg() calls as possible, and returns how many were consumed. A
+  // short count means the socket would block; the caller should retry the
+  // remaining tail later. Datagrams the kernel rejects permanently are logged
+  // and counted as consumed. With GSO enabled, consecutive equal-sized
+  // datagrams to the same endpoint leave as a single super-datagram that the
+  // kernel segments; if the device refuses that, GSO is switched off for the
+  // rest of the socket's life.
+  [[nodiscard]] std::size_t send_batch(const Session::OutboundBatch& batch,
+                                       std::size_t first);
+  // Fills up to min(slots.size(), kMaxDatagramBatch) slots with pending
+  // datagrams and returns how many were filled. Returns 0 when the socket
+  // would block.
+  [[nodiscard]] std::size_t recv_batch(std::span<ReceiveSlot> slots) const;
+  // Opt into UDP segmentation / receive offload. Each returns whether the
+  // kernel supports it; on failure the socket keeps working without it.
+  bool enable_gso();
+  bool enable_gro();
+  // Caps the kernel's per-socket pacing rate (SO_MAX_PACING_RATE, honoured
+  // by the fq qdisc). Returns false where the option is unavailable.
+  bool set_max_pacing_rate(std::uint64_t bytes_per_second);
+  [[nodiscard]] bool gso_enabled() const noexcept { return gso_enabled_; }
+  [[nodiscard]] bool gro_enabled() const noexcept { return gro_enabled_; }
   [[nodiscard]] int native_handle() const noexcept { return fd_; }
 
  private:
@@ -40,6 +119,22 @@ class BsdUdpSocket final {
   void close() noexcept;
 
   int fd_ = -1;
+  bool gso_enabled_ = false;
+  bool gro_enabled_ = false;
 };
 
+// Datagrams waiting for the socket. The first `sent` entries of `batch`
+// have already been handed to the kernel.
+struct TxBacklog final {
+  Session::OutboundBatch batch;
+  std::size_t sent = 0;
+
+  [[nodiscard]] bool empty() const noexcept { return sent == batch.size(); }
+};
+
+// Sends as much of `backlog` as the socket accepts, leaving any would-block
+// tail queued for the next attempt. Once everything is sent the batch is
+// cleared for reuse.
+void flush_backlog(BsdUdpSocket& socket, TxBacklog& backlog);
+
 }  // namespace Rudp::Runtime
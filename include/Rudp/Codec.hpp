@@ -12,7 +12,64 @@ namespace Rudp::Codec {
 
 [[nodiscard]] std::optional<PacketView> decode(std::span<const std::byte> bytes) noexcept;
 
+// Parses the known TLVs in `extensions`, skipping unknown types. Returns
+// nullopt if a known TLV has an invalid length.
+[[nodiscard]] std::optional<HeaderExtensions> decode_extensions(
+    std::span<const std::byte> extensions) noexcept;
+
+[[nodiscard]] std::size_t encoded_extensions_size(
+    const HeaderExtensions& extensions) noexcept;
+
+// BUNDLE payloads (Protocol.md §3.4). next_bundled_message() returns the
+// message at `offset` and moves `offset` past it, or nullopt at the end of
+// the payload or on a truncated record.
+[[nodiscard]] std::optional<std::span<const std::byte>> next_bundled_message(
+    std::span<const std::byte> payload,
+    std::size_t& offset) noexcept;
+[[nodiscard]] bool bundle_well_formed(
+    std::span<const std::byte> payload) noexcept;
+// Appends `message` (at most kMaxBundledMessageSize bytes) as one record.
+void append_bundled_message(std::vector<std::byte>& bundle,
+                            std::span<const std::byte> message);
+
+// FRAGMENT payloads (Protocol.md §3.5). read_fragment_header() returns
+// nullopt for a payload too short for the prefix or an index outside count.
+[[nodiscard]] std::optional<FragmentHeader> read_fragment_header(
+    std::span<const std::byte> payload) noexcept;
+void write_fragment_header(std::span<std::byte> out,
+                           const FragmentHeader& fragment) noexcept;
+// Message bytes per fragment so that a data packet with the largest header it
+// can carry stays within `max_datagram_bytes`; 0 if that leaves no room.
+[[nodiscard]] std::size_t fragment_slice_size(
+    std::size_t max_datagram_bytes) noexcept;
+
+// Total datagram size encode() / encode_into() produce.
+[[nodiscard]] std::size_t encoded_size(const HeaderExtensions& extensions,
+                                       std::size_t payload_size) noexcept;
+
+// Encodes into `out` and returns the bytes written, or nullopt (writing
+// nothing) when `out` is smaller than encoded_size().
+[[nodiscard]] std::optional<std::size_t> encode_into(
+    std::span<std::byte> out,
+    const Header& header,
+    const HeaderExtensions& extensions,
+    std::span<const std::byte> payload) noexcept;
+
+// Rewrites Ack, AckBits and the extension area of an encoded datagram in
+// place, leaving the payload untouched. Returns false, changing nothing, if
+// `extensions` would not encode to exactly the existing HeaderLen.
+[[nodiscard]] bool patch_ack(std::span<std::byte> datagram,
+                             std::uint32_t ack,
+                             std::uint64_t ack_bits,
+                             const HeaderExtensions& extensions) noexcept;
+
+// All encoders write HeaderLen from the encoded extension size; the
+// header's own header_len field is ignored.
+[[nodiscard]] std::vector<std::byte> encode(const Header& header,
+                                            std::span<const std::byte> payload);
+
 [[nodiscard]] std::vector<std::byte> encode(const Header& header,
+                                            const HeaderExtensions& extensions,
                                             std::span<const std::byte> payload);
 
 }  // namespace Rudp::Codec
@@ -11,9 +11,30 @@
 
 namespace Rudp::Config {
 
+// Congestion controller applied to reliable traffic. None keeps the
+// historical behaviour: only the reliable window limits sending.
+enum class CongestionControl : std::uint8_t {
+  None = 0,
+  NewReno = 1,
+  Cubic = 2,
+  BbrLite = 3,
+};
+
+// How a channel's queued data competes with other channels'. Lower priority
+// values are served first; channels of equal priority split the link in
+// proportion to their weights. Unlisted channels use the defaults.
+struct ChannelSchedule final {
+  std::uint32_t channel_id = 0;
+  std::uint8_t priority = 0;
+  std::uint32_t weight = 1;
+};
+
 struct TransportSettings final {
   std::uint64_t initial_rto_ms = 250;
   std::uint64_t max_rto_ms = 4000;
+  // Floor for the RTT-derived RTO; initial_rto_ms applies until the first
+  // sample.
+  std::uint64_t min_rto_ms = 20;
   std::uint32_t max_retransmit_count = 5;
   std::uint64_t handshake_linger_ms = 1000;
   std::uint64_t keepalive_idle_ms = 500;
@@ -21,6 +42,45 @@ struct TransportSettings final {
   std::uint64_t reliable_ack_delay_ms = 2;
   std::uint32_t fast_retx_evidence_threshold = 2;
   bool enable_activity_ack_only = false;
+  // Local receive window, advertised during the handshake. The send window is
+  // the smaller of this and the peer's advertisement (64 if it sends none).
+  std::uint32_t reliable_window_packets =
+      static_cast<std::uint32_t>(Rudp::kReliableWindowSize);
+  CongestionControl congestion_control = CongestionControl::None;
+  // Spread data packets over time instead of sending each poll budget
+  // back-to-back. The rate is pacing_rate_pps when non-zero, otherwise it is
+  // derived from the congestion window and SRTT (no pacing with None).
+  bool enable_pacing = false;
+  std::uint64_t pacing_rate_pps = 0;
+  std::uint32_t pacing_burst_packets = 4;
+  // Offer message bundling during the handshake. Once both peers agree,
+  // consecutive small messages for the same channel share one datagram of
+  // at most max_datagram_bytes.
+  bool enable_bundling = false;
+  // Offer fragmentation during the handshake. Once both peers agree, reliable
+  // messages that do not fit in max_datagram_bytes are split into fragments.
+  bool enable_fragmentation = false;
+  // Offer per-channel ordering during the handshake. Once both peers agree,
+  // each ReliableOrdered channel is delivered independently, so a loss on one
+  // no longer holds back the others.
+  bool enable_ordered_streams = false;
+  std::size_t max_datagram_bytes = 1200;
+  // Receive-side cap on bytes held by partially reassembled messages. A
+  // fragment that would start a message past the cap is left unacknowledged
+  // so the sender retries once memory frees up.
+  std::size_t max_reassembly_bytes = 1U << 20U;
+  // Server side: a closed session's conn_id is not handed out again for this
+  // long, so stray datagrams of the old connection cannot reach a new one.
+  // At most max_retired_conn_ids are remembered; past that the oldest is
+  // forgotten early.
+  std::uint64_t retired_conn_id_quiet_ms = 30000;
+  std::size_t max_retired_conn_ids = 65536;
+  // Server side: answer SYNs statelessly with a cookie in the SYN-ACK and
+  // only build a session once the client echoes it, so a flood of spoofed
+  // SYNs costs no memory. Clients always echo cookies they are given.
+  bool enable_handshake_cookies = false;
+  // Taken from the runtime profile's channel list; not settable from .env.
+  std::vector<ChannelSchedule> channel_schedules;
 };
 
 struct RuntimeSettings final {
@@ -30,9 +90,15 @@ struct RuntimeSettings final {
   std::uint16_t client_server_port = 9000;
   std::string client_bind_address = "0.0.0.0";
   std::size_t socket_buffer_size = 1500;
-  std::uint32_t server_loop_sleep_us = 10'000;
-  std::uint32_t client_select_timeout_us = 10'000;
   std::uint32_t client_poll_budget = 8;
+  std::uint32_t io_batch_size = 32;
+  bool enable_gso = false;
+  bool enable_gro = false;
+  // SO_MAX_PACING_RATE cap in bytes per second; 0 leaves the socket alone.
+  std::uint64_t max_pacing_rate_bytes = 0;
+  // Server worker threads, each with its own SO_REUSEPORT socket and session
+  // manager; 0 starts one per hardware thread.
+  std::uint32_t server_shards = 1;
   std::string server_log_path = "logs/rudp_server.log";
   std::string client_log_path = "logs/rudp_client.log";
 };
@@ -52,6 +118,8 @@ struct ChannelDefinition final {
   std::string name;
   Rudp::ChannelType type = Rudp::ChannelType::Unreliable;
   bool is_default = false;
+  std::uint8_t priority = 0;
+  std::uint32_t weight = 1;
 };
 
 struct RuntimeProfile final {
@@ -62,9 +130,18 @@ struct RuntimeProfile final {
   std::uint16_t remote_port = 9000;
   std::string log_path = "logs/rudp.log";
   std::size_t socket_buffer_size = 1500;
-  std::uint32_t loop_sleep_us = 10'000;
-  std::uint32_t select_timeout_us = 10'000;
   std::uint32_t poll_budget = 8;
+  std::uint32_t io_batch_size = 32;
+  bool enable_gso = false;
+  bool enable_gro = false;
+  std::uint64_t max_pacing_rate_bytes = 0;
+  std::uint32_t server_shards = 1;
+  CongestionControl congestion_control = CongestionControl::None;
+  bool enable_pacing = false;
+  bool enable_bundling = false;
+  bool enable_fragmentation = false;
+  bool enable_ordered_streams = false;
+  bool enable_handshake_cookies = false;
   std::vector<ChannelDefinition> channels;
 };
 
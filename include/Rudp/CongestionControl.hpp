@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "Rudp/Config.hpp"
+
+namespace Rudp::Session {
+
+// Delivery-rate bookkeeping captured when a reliable packet is sent: how many
+// packets had been acknowledged so far, and when the latest of them was.
+struct DeliveryStamp final {
+  std::uint64_t delivered = 0;
+  std::uint64_t delivered_ms = 0;
+};
+
+// Per-session congestion window, in packets, for reliable traffic. The
+// algorithm is picked once at construction; all of them are driven by the
+// same ACK and loss events from TxHandler:
+//
+//   on_packet_acked()      once per newly released inflight packet
+//   on_ack_processed()     once per received ACK, after the releases
+//   on_fast_loss()         a packet became a fast retransmit candidate
+//   on_retransmit_timeout() a packet's RTO expired
+//
+// Loss reactions happen at most once per window of data: losses of seqs sent
+// before the previous reduction are part of the same congestion event.
+// With CongestionControl::None the window never limits sending.
+class CongestionController final {
+ public:
+  using Algorithm = Rudp::Config::CongestionControl;
+
+  static constexpr double kInitialWindow = 10.0;
+  static constexpr double kMinWindow = 2.0;
+
+  CongestionController() = default;
+  explicit CongestionController(Algorithm algorithm) noexcept;
+
+  [[nodiscard]] Algorithm algorithm() const noexcept { return algorithm_; }
+
+  // Whole packets the window currently allows in flight.
+  [[nodiscard]] std::uint32_t window_packets() const noexcept;
+  [[nodiscard]] bool can_send(std::size_t inflight_packets) const noexcept;
+  [[nodiscard]] bool in_slow_start() const noexcept { return cwnd_ < ssthresh_; }
+
+  // Estimated bottleneck bandwidth in packets per second (BbrLite only).
+  [[nodiscard]] std::optional<double> bottleneck_rate() const noexcept;
+
+  [[nodiscard]] DeliveryStamp delivery_stamp(std::uint64_t now_ms) const noexcept;
+
+  void on_packet_acked(const DeliveryStamp& sent, std::uint64_t now_ms) noexcept;
+  void on_ack_processed(std::uint32_t cumulative_ack,
+                        std::optional<std::uint64_t> rtt_sample_ms,
+                        std::uint64_t srtt_us,
+                        std::uint64_t now_ms) noexcept;
+  void on_fast_loss(std::uint32_t seq,
+                    std::uint32_t next_seq,
+                    std::uint64_t now_ms) noexcept;
+  void on_retransmit_timeout(std::uint32_t seq,
+                             std::uint32_t next_seq,
+                             std::uint64_t now_ms) noexcept;
+
+ private:
+  void grow_new_reno(std::uint32_t acked) noexcept;
+  void grow_cubic(std::uint32_t acked,
+                  std::uint64_t srtt_us,
+                  std::uint64_t now_ms) noexcept;
+  void grow_bbr(std::uint32_t acked) noexcept;
+  void update_bbr_filters(std::optional<std::uint64_t> rtt_sample_ms,
+                          std::uint64_t now_ms) noexcept;
+  [[nodiscard]] bool in_recovery(std::uint32_t seq) const noexcept;
+  void enter_recovery(std::uint32_t next_seq) noexcept;
+  void reduce_on_loss() noexcept;
+
+  Algorithm algorithm_ = Algorithm::None;
+  double cwnd_ = kInitialWindow;
+  double ssthresh_ = 1e12;
+
+  // Set by any loss reduction until the cumulative ACK reaches recovery_end_;
+  // fast_recovery_ additionally freezes growth (timeouts restart slow start).
+  bool recovering_ = false;
+  bool fast_recovery_ = false;
+  std::uint32_t recovery_end_ = 0;
+
+  // CUBIC (RFC 8312).
+  double w_max_ = 0.0;
+  double w_est_ = 0.0;
+  double cubic_k_s_ = 0.0;
+  std::optional<std::uint64_t> epoch_start_ms_;
+
+  // Delivery-rate sampling, shared by every algorithm but only consumed by
+  // BbrLite.
+  std::uint64_t delivered_ = 0;
+  std::uint64_t delivered_ms_ = 0;
+  std::uint32_t acked_since_ack_ = 0;
+  double ack_rate_sample_ = 0.0;
+  bool round_started_ = false;
+  std::uint64_t next_round_delivered_ = 0;
+
+  // BbrLite: windowed max bandwidth (packets/ms) and min RTT.
+  double max_bw_ = 0.0;
+  std::uint64_t max_bw_round_ = 0;
+  std::uint64_t round_count_ = 0;
+  std::optional<std::uint64_t> min_rtt_ms_;
+  std::uint64_t min_rtt_stamp_ms_ = 0;
+  double full_bw_ = 0.0;
+  std::uint32_t full_bw_rounds_ = 0;
+  bool pipe_filled_ = false;
+};
+
+}  // namespace Rudp::Session
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Rudp::Session {
+
+// Hands out server conn_ids for one shard of `shard_count`. Every id
+// satisfies `id % shard_count == shard_index`, so a packet can be steered to
+// its shard from the ConnId field alone (see shard_of()).
+//
+// The quotient `id / shard_count` is a sequence counter passed through a
+// keyed permutation of the shard's id space. Ids look random to peers yet
+// cannot repeat until the whole space has been handed out; each pass over it
+// is one generation. The key comes from std::random_device once, at
+// construction, so next() makes no system calls.
+class ConnIdAllocator final {
+ public:
+  explicit ConnIdAllocator(std::uint32_t shard_index = 0,
+                           std::uint32_t shard_count = 1);
+  // Fixed key, for reproducible sequences in tests.
+  ConnIdAllocator(std::uint32_t shard_index,
+                  std::uint32_t shard_count,
+                  std::uint64_t key) noexcept;
+
+  // Next id of this shard; never 0. The caller still rejects ids that are
+  // live or retired, which only matters once a generation wraps.
+  [[nodiscard]] std::uint32_t next() noexcept;
+
+  [[nodiscard]] std::uint32_t shard_index() const noexcept {
+    return shard_index_;
+  }
+  [[nodiscard]] std::uint32_t shard_count() const noexcept {
+    return shard_count_;
+  }
+  // Completed passes over the id space.
+  [[nodiscard]] std::uint64_t generation() const noexcept {
+    return counter_ / slot_count_;
+  }
+
+  [[nodiscard]] static std::uint32_t shard_of(
+      std::uint32_t conn_id,
+      std::uint32_t shard_count) noexcept {
+    return shard_count == 0 ? 0U : conn_id % shard_count;
+  }
+
+ private:
+  [[nodiscard]] std::uint64_t permute(std::uint64_t slot) const noexcept;
+
+  std::uint32_t shard_index_ = 0;
+  std::uint32_t shard_count_ = 1;
+  // Ids of this shard are `slot * shard_count_ + shard_index_` for slot in
+  // [0, slot_count_). The permutation runs over the smallest power-of-two
+  // domain covering them (mask_) and cycle-walks back into range.
+  std::uint64_t slot_count_ = 1;
+  std::uint64_t mask_ = 0;
+  unsigned domain_bits_ = 0;
+  std::uint64_t key_ = 0;
+  std::uint64_t counter_ = 0;
+};
+
+}  // namespace Rudp::Session
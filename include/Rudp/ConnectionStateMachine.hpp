@@ -8,18 +8,6 @@
 
 namespace Rudp::Session {
 
-enum class ControlKind : std::uint8_t {
-  None = 0,
-  Syn = 1,
-  SynAck = 2,
-  Ack = 3,
-  Fin = 4,
-  Rst = 5,
-  Ping = 6,
-  Pong = 7,
-  Invalid = 8,
-};
-
 struct ConnectionDecision final {
   bool valid = true;
   std::optional<ConnectionState> next_state;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Rudp::Session {
+
+// Reusable output buffer for batched transmit polling. Datagrams are packed
+// back to back into one byte buffer and addressed by index. clear() keeps the
+// storage, so a long-lived arena stops allocating once it has grown to the
+// largest batch it has carried.
+class DatagramArena final {
+ public:
+  explicit DatagramArena(std::size_t reserve_bytes = 0);
+
+  // Writable space of at least `size` bytes after the last datagram. Growing
+  // the storage here invalidates spans returned by operator[].
+  [[nodiscard]] std::span<std::byte> prepare(std::size_t size);
+  // Appends the first `size` bytes of the last prepare() as one datagram.
+  void commit(std::size_t size);
+  void clear() noexcept;
+
+  [[nodiscard]] std::size_t size() const noexcept { return extents_.size(); }
+  [[nodiscard]] bool empty() const noexcept { return extents_.empty(); }
+  [[nodiscard]] std::span<const std::byte> operator[](
+      std::size_t index) const noexcept;
+
+ private:
+  struct Extent final {
+    std::size_t offset = 0;
+    std::size_t size = 0;
+  };
+
+  std::vector<std::byte> storage_;
+  std::size_t used_ = 0;
+  std::vector<Extent> extents_;
+};
+
+}  // namespace Rudp::Session
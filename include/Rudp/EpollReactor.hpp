@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace Rudp::Runtime {
+
+struct ReadyFd final {
+  int fd = -1;
+  bool readable = false;
+  bool writable = false;
+};
+
+// Single-threaded epoll loop driver. Besides caller-registered descriptors it
+// owns a timerfd, armed to the next session deadline, and an eventfd that
+// other threads use to interrupt a wait. Deadlines are steady_clock
+// milliseconds, which share CLOCK_MONOTONIC's epoch on Linux.
+class EpollReactor final {
+ public:
+  EpollReactor() = default;
+  ~EpollReactor();
+
+  EpollReactor(const EpollReactor&) = delete;
+  EpollReactor& operator=(const EpollReactor&) = delete;
+
+  EpollReactor(EpollReactor&& other) noexcept;
+  EpollReactor& operator=(EpollReactor&& other) noexcept;
+
+  [[nodiscard]] static std::optional<EpollReactor> create();
+
+  // Registers `fd`, or updates its interest set if already registered.
+  [[nodiscard]] bool watch(int fd, bool readable, bool writable);
+  [[nodiscard]] bool unwatch(int fd);
+
+  // Thread-safe: makes the current or next wait() return immediately.
+  void notify() const noexcept;
+
+  // Blocks until a watched descriptor is ready, `deadline_ms` passes, or
+  // notify() is called; nullopt deadline waits for I/O only. Fills `ready`
+  // with caller descriptors and returns how many were written. The internal
+  // timer and wake descriptors are drained here and never reported. Returns
+  // nullopt on an unrecoverable epoll error; EINTR yields 0.
+  [[nodiscard]] std::optional<std::size_t> wait(
+      std::optional<std::uint64_t> deadline_ms,
+      std::span<ReadyFd> ready);
+
+ private:
+  EpollReactor(int epoll_fd, int timer_fd, int wake_fd) noexcept
+      : epoll_fd_(epoll_fd), timer_fd_(timer_fd), wake_fd_(wake_fd) {}
+  [[nodiscard]] bool arm_timer(std::optional<std::uint64_t> deadline_ms);
+  void close() noexcept;
+
+  int epoll_fd_ = -1;
+  int timer_fd_ = -1;
+  int wake_fd_ = -1;
+  std::optional<std::uint64_t> armed_deadline_ms_;
+};
+
+[[nodiscard]] inline const ReadyFd* find_ready(std::span<const ReadyFd> ready,
+                                               int fd) noexcept {
+  for (const auto& entry : ready) {
+    if (entry.fd == fd) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+// Converts a session deadline into the reactor wait deadline. If the last
+// poll at `now_ms` produced nothing, or output is blocked on the socket, a
+// deadline at or before `now_ms` would only spin, so it is pushed out by one
+// millisecond.
+[[nodiscard]] inline std::optional<std::uint64_t> reactor_deadline_ms(
+    std::optional<std::uint64_t> session_deadline_ms,
+    std::uint64_t now_ms,
+    bool tx_stalled) noexcept {
+  if (tx_stalled && session_deadline_ms.has_value() &&
+      *session_deadline_ms <= now_ms) {
+    return now_ms + 1U;
+  }
+  return session_deadline_ms;
+}
+
+}  // namespace Rudp::Runtime
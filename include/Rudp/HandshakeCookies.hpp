@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "Rudp/Protocol.hpp"
+
+namespace Rudp::Session {
+
+struct EndpointKey;
+
+// The parts of a client's SYN a server must remember to finish the
+// handshake. Window and features are 0 when the SYN did not carry them.
+struct CookieSyn final {
+  std::uint32_t client_isn = 0;
+  std::uint32_t window = 0;
+  std::uint32_t features = 0;
+};
+
+struct IssuedCookie final {
+  Rudp::HandshakeCookie cookie{};
+  // Seq of the SYN-ACK; the client acknowledges it with Ack = server_isn + 1.
+  std::uint32_t server_isn = 0;
+};
+
+// Stateless SYN cookies (Protocol.md §7.4). A cookie holds the CookieSyn and
+// its issue time in the clear, plus the low half of a SipHash-2-4 tag over
+// those fields, the peer's endpoint and the conn_id offered to it. The high
+// half of the tag becomes the server ISN, so the client's Ack field carries
+// the rest of the tag back.
+//
+// The 128-bit key is drawn from std::random_device once per instance, so
+// only the instance that issued a cookie can verify it.
+class HandshakeCookies final {
+ public:
+  HandshakeCookies();
+  HandshakeCookies(std::uint64_t key0, std::uint64_t key1) noexcept;
+
+  [[nodiscard]] IssuedCookie issue(const EndpointKey& endpoint,
+                                   std::uint32_t conn_id,
+                                   const CookieSyn& syn,
+                                   std::uint64_t now_ms) const noexcept;
+
+  // Returns the SYN a cookie was issued for when this instance issued it to
+  // `endpoint` for `conn_id`, with `server_isn` as the SYN-ACK seq, at most
+  // `lifetime_ms` before `now_ms`.
+  [[nodiscard]] std::optional<CookieSyn> verify(
+      const EndpointKey& endpoint,
+      std::uint32_t conn_id,
+      std::uint32_t server_isn,
+      const Rudp::HandshakeCookie& cookie,
+      std::uint64_t now_ms,
+      std::uint64_t lifetime_ms) const noexcept;
+
+ private:
+  [[nodiscard]] std::uint64_t tag(const EndpointKey& endpoint,
+                                  std::uint32_t conn_id,
+                                  std::uint32_t issued_ms,
+                                  const CookieSyn& syn) const noexcept;
+
+  std::uint64_t key0_ = 0;
+  std::uint64_t key1_ = 0;
+};
+
+}  // namespace Rudp::Session
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+namespace Rudp::Session {
+
+// Token bucket that spaces data transmissions. Tokens, in packets, refill at
+// the configured rate up to `burst_packets`; each paced send spends one.
+// Without a rate the pacer is disabled and every send is allowed, which is
+// also how a fresh session starts.
+class Pacer final {
+ public:
+  static constexpr std::uint32_t kDefaultBurstPackets = 4;
+
+  Pacer() : Pacer(kDefaultBurstPackets) {}
+  explicit Pacer(std::uint32_t burst_packets) noexcept;
+
+  // Sets the refill rate in packets per second (nullopt or <= 0 disables
+  // pacing). Tokens earned at the previous rate are kept.
+  void set_rate(std::optional<double> packets_per_second,
+                std::uint64_t now_ms) noexcept;
+
+  [[nodiscard]] std::optional<double> rate() const noexcept;
+  [[nodiscard]] bool can_send(std::uint64_t now_ms) const noexcept;
+  void on_sent(std::uint64_t now_ms) noexcept;
+
+  // Earliest time can_send() holds: `now_ms` if it already does.
+  [[nodiscard]] std::uint64_t next_send_ms(std::uint64_t now_ms) const noexcept;
+
+ private:
+  [[nodiscard]] double tokens_at(std::uint64_t now_ms) const noexcept;
+
+  double burst_ = kDefaultBurstPackets;
+  double tokens_ = kDefaultBurstPackets;
+  // Packets per millisecond; 0 when pacing is disabled.
+  double rate_per_ms_ = 0.0;
+  std::uint64_t last_update_ms_ = 0;
+};
+
+}  // namespace Rudp::Session
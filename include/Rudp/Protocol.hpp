@@ -1,15 +1,38 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <span>
 #include <vector>
 
 namespace Rudp {
 
 constexpr std::uint8_t kHeaderLength = 28;
+// HeaderLen is one byte, so fixed header plus extensions never exceed this.
+constexpr std::size_t kMaxHeaderLength = 0xff;
 constexpr std::size_t kAckBitsWindow = 64;
+// Reliable window assumed for a peer that does not negotiate one (v1.1).
 constexpr std::size_t kReliableWindowSize = 64;
+constexpr std::size_t kMaxReliableWindowSize = 4096;
+constexpr std::size_t kMaxSackRanges = 8;
+// Bits of the FEATURES extension (Protocol.md §3.4).
+constexpr std::uint32_t kFeatureBundle = 0x01;
+constexpr std::uint32_t kFeatureFragment = 0x02;
+constexpr std::uint32_t kFeatureOrderedStreams = 0x04;
+// Each message in a BUNDLE payload is prefixed by a uint16 length.
+constexpr std::size_t kBundleRecordHeaderSize = 2;
+constexpr std::size_t kMaxBundledMessageSize = 0xffff;
+// FRAGMENT payloads start with uint32 MessageSize, uint16 Index, uint16 Count,
+// uint32 FirstSeq.
+constexpr std::size_t kFragmentHeaderSize = 12;
+constexpr std::size_t kMaxFragmentCount = 0xffff;
+// Opaque handshake cookie a server may put in its SYN-ACK; the client echoes
+// it until it hears from the server again (Protocol.md §7.4).
+constexpr std::size_t kHandshakeCookieSize = 20;
+
+using HandshakeCookie = std::array<std::byte, kHandshakeCookieSize>;
 
 enum class ChannelType : std::uint8_t {
   ReliableOrdered = 0,
@@ -25,10 +48,23 @@ enum class Flag : std::uint8_t {
   Ping = 0x08,
   Pong = 0x10,
   Ack = 0x20,
+  // Payload is a sequence of length-prefixed messages (Protocol.md §3.4).
+  Bundle = 0x40,
+  // Payload is one piece of a larger message (Protocol.md §3.5).
+  Fragment = 0x80,
 };
 
 using Flags = std::uint8_t;
 
+// TLV types carried between the fixed header and HeaderLen (Protocol.md §3.3).
+enum class ExtensionType : std::uint8_t {
+  Window = 0x01,
+  SackRanges = 0x02,
+  Features = 0x03,
+  StreamSeq = 0x04,
+  Cookie = 0x05,
+};
+
 struct Header final {
   std::uint32_t conn_id = 0;
   std::uint32_t seq = 0;
@@ -43,9 +79,44 @@ struct Header final {
   [[nodiscard]] bool hasFlag(Flag flag) const noexcept;
 };
 
+// Received reliable seqs [begin, end) beyond the AckBits bitmap.
+struct SackRange final {
+  std::uint32_t begin = 0;
+  std::uint32_t end = 0;
+};
+
+struct FragmentHeader final {
+  std::uint32_t message_size = 0;
+  std::uint16_t index = 0;
+  std::uint16_t count = 0;
+  // Seq of fragment 0, which names the message among its channel's others.
+  std::uint32_t first_seq = 0;
+};
+
+struct HeaderExtensions final {
+  std::optional<std::uint32_t> window;
+  std::optional<std::uint32_t> features;
+  // Per-channel ordering seq of a ReliableOrdered packet (Protocol.md §6.2).
+  std::optional<std::uint32_t> stream_seq;
+  std::optional<HandshakeCookie> cookie;
+  std::array<SackRange, kMaxSackRanges> sack_ranges{};
+  std::uint8_t sack_range_count = 0;
+
+  [[nodiscard]] std::span<const SackRange> sacks() const noexcept {
+    return std::span<const SackRange>(sack_ranges.data(), sack_range_count);
+  }
+  [[nodiscard]] bool empty() const noexcept {
+    return !window.has_value() && !features.has_value() &&
+           !stream_seq.has_value() && !cookie.has_value() &&
+           sack_range_count == 0;
+  }
+};
+
 struct PacketView final {
   Header header;
   std::span<const std::byte> payload;
+  // Raw TLV bytes between the fixed header and HeaderLen.
+  std::span<const std::byte> extensions;
 };
 
 [[nodiscard]] constexpr bool seq_lt(std::uint32_t lhs,
@@ -15,6 +15,16 @@ class RxHandler final {
                                          ControlKind control_kind,
                                          RxSessionState& rx);
 
+  // Also takes the packet's decoded TLVs. A STREAM_SEQ puts a ReliableOrdered
+  // packet in its channel's own delivery order instead of the session-wide
+  // one.
+  [[nodiscard]] RxPacketResult on_packet(
+      const Rudp::PacketView& packet,
+      const Rudp::HeaderExtensions& extensions,
+      std::uint64_t now_ms,
+      ControlKind control_kind,
+      RxSessionState& rx);
+
   [[nodiscard]] std::vector<SessionEvent> drain_events(RxSessionState& rx);
 
  private:
@@ -27,6 +37,10 @@ class RxHandler final {
   void handle_reliable_ordered(const Rudp::PacketView& packet,
                                RxSessionState& rx);
 
+  void handle_ordered_stream(const Rudp::PacketView& packet,
+                             std::uint32_t stream_seq,
+                             RxSessionState& rx);
+
   void handle_reliable_unordered(const Rudp::PacketView& packet,
                                  RxSessionState& rx);
 
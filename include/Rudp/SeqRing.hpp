@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Rudp/Protocol.hpp"
+
+namespace Rudp::Session {
+
+// Fixed-capacity map from 32-bit sequence numbers to values for a sliding
+// window of live seqs. A seq lives in slot `seq & (capacity - 1)`, and an
+// occupancy bitmap tracks which slots hold a value, so insert, lookup and
+// erase are O(1) and in-order scans skip empty slots a word at a time.
+//
+// All live seqs must fit in one window of `capacity()` consecutive seqs
+// (wrap-around aware); insert() rejects anything that would not. Capacity is
+// rounded up to a power of two and is at least 64.
+template <typename T>
+class SeqRing final {
+ public:
+  template <bool IsConst>
+  class basic_iterator final {
+   public:
+    using ring_type = std::conditional_t<IsConst, const SeqRing, SeqRing>;
+    using value_ref = std::conditional_t<IsConst, const T&, T&>;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<std::uint32_t, value_ref>;
+    using difference_type = std::ptrdiff_t;
+
+    basic_iterator() = default;
+
+    [[nodiscard]] value_type operator*() const {
+      return value_type{seq_, ring_->slots_[ring_->slot_of(seq_)]};
+    }
+    basic_iterator& operator++() {
+      seq_ = ring_->next_occupied(seq_ + 1U);
+      return *this;
+    }
+    [[nodiscard]] bool operator==(const basic_iterator& other) const noexcept {
+      return seq_ == other.seq_;
+    }
+    [[nodiscard]] std::uint32_t seq() const noexcept { return seq_; }
+
+   private:
+    friend class SeqRing;
+    basic_iterator(ring_type* ring, std::uint32_t seq) : ring_(ring), seq_(seq) {}
+
+    ring_type* ring_ = nullptr;
+    std::uint32_t seq_ = 0;
+  };
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  SeqRing() : SeqRing(Rudp::kReliableWindowSize) {}
+  explicit SeqRing(std::size_t capacity) {
+    const auto rounded = std::bit_ceil(capacity < 64U ? std::size_t{64} : capacity);
+    slots_.resize(rounded);
+    occupied_.resize(rounded / 64U);
+    mask_ = static_cast<std::uint32_t>(rounded - 1U);
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return slots_.size(); }
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  // Oldest live seq. Only meaningful when !empty().
+  [[nodiscard]] std::uint32_t front_seq() const noexcept { return begin_; }
+
+  [[nodiscard]] bool contains(std::uint32_t seq) const noexcept {
+    return in_span(seq) && is_occupied(slot_of(seq));
+  }
+
+  [[nodiscard]] T* find(std::uint32_t seq) noexcept {
+    return contains(seq) ? &slots_[slot_of(seq)] : nullptr;
+  }
+  [[nodiscard]] const T* find(std::uint32_t seq) const noexcept {
+    return contains(seq) ? &slots_[slot_of(seq)] : nullptr;
+  }
+
+  // Precondition: contains(seq).
+  [[nodiscard]] T& at(std::uint32_t seq) noexcept { return slots_[slot_of(seq)]; }
+  [[nodiscard]] const T& at(std::uint32_t seq) const noexcept {
+    return slots_[slot_of(seq)];
+  }
+
+  // Stores `value` under `seq`. Returns false, leaving the ring unchanged, if
+  // the seq is already present or would stretch the live span past capacity.
+  bool insert(std::uint32_t seq, T&& value) {
+    if (empty()) {
+      begin_ = seq;
+      end_ = seq + 1U;
+    } else if (Rudp::seq_ge(seq, end_)) {
+      if (seq + 1U - begin_ > capacity()) {
+        return false;
+      }
+      end_ = seq + 1U;
+    } else if (Rudp::seq_lt(seq, begin_)) {
+      if (end_ - seq > capacity()) {
+        return false;
+      }
+      begin_ = seq;
+    } else if (is_occupied(slot_of(seq))) {
+      return false;
+    }
+
+    const auto slot = slot_of(seq);
+    slots_[slot] = std::move(value);
+    occupied_[slot >> 6U] |= std::uint64_t{1} << (slot & 63U);
+    ++size_;
+    return true;
+  }
+
+  bool emplace(std::uint32_t seq, T&& value) { return insert(seq, std::move(value)); }
+
+  // Removes `seq` and returns its value moved out, or a default T if absent.
+  T take(std::uint32_t seq) {
+    if (!contains(seq)) {
+      return T{};
+    }
+    const auto slot = slot_of(seq);
+    T value = std::exchange(slots_[slot], T{});
+    occupied_[slot >> 6U] &= ~(std::uint64_t{1} << (slot & 63U));
+    --size_;
+    if (size_ == 0) {
+      begin_ = end_;
+    } else if (seq == begin_) {
+      begin_ = next_occupied(seq + 1U);
+    }
+    return value;
+  }
+
+  bool erase(std::uint32_t seq) {
+    if (!contains(seq)) {
+      return false;
+    }
+    static_cast<void>(take(seq));
+    return true;
+  }
+
+  iterator erase(iterator it) {
+    const auto next = next_occupied(it.seq_ + 1U);
+    static_cast<void>(erase(it.seq_));
+    return iterator(this, empty() ? end_ : next);
+  }
+
+  void clear() {
+    while (size_ != 0) {
+      static_cast<void>(take(begin_));
+    }
+  }
+
+  [[nodiscard]] iterator begin() noexcept {
+    return iterator(this, empty() ? end_ : begin_);
+  }
+  [[nodiscard]] iterator end() noexcept { return iterator(this, end_); }
+  [[nodiscard]] const_iterator begin() const noexcept {
+    return const_iterator(this, empty() ? end_ : begin_);
+  }
+  [[nodiscard]] const_iterator end() const noexcept {
+    return const_iterator(this, end_);
+  }
+
+ private:
+  [[nodiscard]] std::size_t slot_of(std::uint32_t seq) const noexcept {
+    return static_cast<std::size_t>(seq & mask_);
+  }
+
+  [[nodiscard]] bool is_occupied(std::size_t slot) const noexcept {
+    return (occupied_[slot >> 6U] & (std::uint64_t{1} << (slot & 63U))) != 0;
+  }
+
+  [[nodiscard]] bool in_span(std::uint32_t seq) const noexcept {
+    return size_ != 0 && seq - begin_ < end_ - begin_;
+  }
+
+  // First occupied seq in [seq, end_), or end_ if there is none. Scans the
+  // bitmap one word at a time; capacity is a multiple of 64, so a run never
+  // straddles the wrap point in the middle of a word.
+  [[nodiscard]] std::uint32_t next_occupied(std::uint32_t seq) const noexcept {
+    if (size_ == 0) {
+      return end_;
+    }
+    std::uint32_t remaining = end_ - seq;
+    if (remaining > end_ - begin_) {
+      return end_;
+    }
+    while (remaining > 0) {
+      const auto slot = slot_of(seq);
+      const auto bit = static_cast<unsigned>(slot & 63U);
+      const auto chunk = std::min<std::uint32_t>(64U - bit, remaining);
+      auto bits = occupied_[slot >> 6U] >> bit;
+      if (chunk < 64U) {
+        bits &= (std::uint64_t{1} << chunk) - 1U;
+      }
+      if (bits != 0) {
+        return seq + static_cast<std::uint32_t>(std::countr_zero(bits));
+      }
+      seq += chunk;
+      remaining -= chunk;
+    }
+    return end_;
+  }
+
+  std::vector<T> slots_;
+  std::vector<std::uint64_t> occupied_;
+  std::uint32_t mask_ = 0;
+  std::uint32_t begin_ = 0;
+  std::uint32_t end_ = 0;
+  std::size_t size_ = 0;
+};
+
+// Fixed-capacity set of 32-bit sequence numbers using the same slot mapping as
+// SeqRing. It does not track a live span: callers must keep every set seq
+// within one capacity window so slots never alias.
+class SeqBitset final {
+ public:
+  SeqBitset() : SeqBitset(Rudp::kReliableWindowSize) {}
+  explicit SeqBitset(std::size_t capacity) {
+    const auto rounded = std::bit_ceil(capacity < 64U ? std::size_t{64} : capacity);
+    words_.resize(rounded / 64U);
+    mask_ = static_cast<std::uint32_t>(rounded - 1U);
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return words_.size() * 64U; }
+  [[nodiscard]] std::size_t count() const noexcept { return count_; }
+  [[nodiscard]] bool any() const noexcept { return count_ != 0; }
+
+  [[nodiscard]] bool test(std::uint32_t seq) const noexcept {
+    return (words_[word_of(seq)] & bit_of(seq)) != 0;
+  }
+  void set(std::uint32_t seq) noexcept {
+    if (!test(seq)) {
+      words_[word_of(seq)] |= bit_of(seq);
+      ++count_;
+    }
+  }
+  void reset(std::uint32_t seq) noexcept {
+    if (test(seq)) {
+      words_[word_of(seq)] &= ~bit_of(seq);
+      --count_;
+    }
+  }
+
+  // First seq in [from, limit) whose bit equals `value`, or `limit` if none.
+  // `limit - from` must not exceed capacity().
+  [[nodiscard]] std::uint32_t find(std::uint32_t from,
+                                   std::uint32_t limit,
+                                   bool value) const noexcept {
+    std::uint32_t remaining = limit - from;
+    while (remaining > 0) {
+      const auto slot = from & mask_;
+      const auto bit = static_cast<unsigned>(slot & 63U);
+      const auto chunk = std::min<std::uint32_t>(64U - bit, remaining);
+      auto bits = words_[slot >> 6U];
+      if (!value) {
+        bits = ~bits;
+      }
+      bits >>= bit;
+      if (chunk < 64U) {
+        bits &= (std::uint64_t{1} << chunk) - 1U;
+      }
+      if (bits != 0) {
+        return from + static_cast<std::uint32_t>(std::countr_zero(bits));
+      }
+      from += chunk;
+      remaining -= chunk;
+    }
+    return limit;
+  }
+
+ private:
+  [[nodiscard]] std::size_t word_of(std::uint32_t seq) const noexcept {
+    return static_cast<std::size_t>((seq & mask_) >> 6U);
+  }
+  [[nodiscard]] static std::uint64_t bit_of(std::uint32_t seq) noexcept {
+    return std::uint64_t{1} << (seq & 63U);
+  }
+
+  std::vector<std::uint64_t> words_;
+  std::uint32_t mask_ = 0;
+  std::size_t count_ = 0;
+};
+
+}  // namespace Rudp::Session
@@ -1,26 +1,59 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "Rudp/ConnIdAllocator.hpp"
+#include "Rudp/DatagramArena.hpp"
+#include "Rudp/HandshakeCookies.hpp"
 #include "Rudp/Session.hpp"
+#include "Rudp/SessionSlab.hpp"
+#include "Rudp/TimerWheel.hpp"
 
 namespace Rudp::Session {
 
+enum class AddressFamily : std::uint8_t {
+  Unspecified = 0,
+  IPv4 = 4,
+  IPv6 = 6,
+};
+
+// Peer address in binary form so lookups on the receive path never allocate
+// or hash strings. `address` holds the raw network-order bytes (IPv4 uses the
+// first 4); `port` is in host order. Text conversion is only for config input
+// and logging.
 struct EndpointKey final {
-  std::string address;
+  std::array<std::uint8_t, 16> address{};
   std::uint16_t port = 0;
+  AddressFamily family = AddressFamily::Unspecified;
+
+  [[nodiscard]] static EndpointKey ipv4(std::uint32_t host_order_address,
+                                        std::uint16_t port) noexcept;
+  // Parses a numeric IPv4 or IPv6 literal; host names are not resolved.
+  [[nodiscard]] static std::optional<EndpointKey> parse(
+      std::string_view address,
+      std::uint16_t port);
+
+  [[nodiscard]] std::string address_string() const;
+  // "a.b.c.d:port" or "[v6]:port".
+  [[nodiscard]] std::string to_string() const;
 
   [[nodiscard]] bool operator==(const EndpointKey& other) const noexcept =
       default;
 };
 
+static_assert(std::is_trivially_copyable_v<EndpointKey>);
+
 struct EndpointKeyHash final {
   [[nodiscard]] std::size_t operator()(const EndpointKey& endpoint) const
       noexcept;
@@ -31,19 +64,82 @@ struct OutboundDatagram final {
   std::vector<std::byte> bytes;
 };
 
+// Output of ServerSessionManager::poll_tx_batch(): datagram i is
+// `datagrams[i]` and goes to `endpoints[i]`. Both containers keep their
+// storage across clear(), so one batch can be reused every loop iteration.
+struct OutboundBatch final {
+  DatagramArena datagrams;
+  std::vector<EndpointKey> endpoints;
+
+  [[nodiscard]] std::size_t size() const noexcept { return endpoints.size(); }
+  [[nodiscard]] bool empty() const noexcept { return endpoints.empty(); }
+  void clear() noexcept {
+    datagrams.clear();
+    endpoints.clear();
+  }
+};
+
 struct ServerSessionEvent final {
   EndpointKey endpoint;
   std::optional<std::uint32_t> conn_id;
   SessionEvent event;
 };
 
+// conn_ids of closed sessions, reserved for `quiet_ms` after they close so
+// they are not reassigned while the old peer may still be sending. Entries
+// sit in a FIFO ordered by expiry (the quiet period is fixed, so retirement
+// order is expiry order) next to a set for O(1) lookups; expiry pops from
+// the front. At most `capacity` ids are kept, the oldest going first.
+class RetiredConnIds final {
+ public:
+  RetiredConnIds(std::uint64_t quiet_ms, std::size_t capacity)
+      : quiet_ms_(quiet_ms), capacity_(capacity) {}
+
+  void retire(std::uint32_t conn_id, std::uint64_t now_ms);
+  // Forgets every id whose quiet period ended at or before `now_ms`.
+  void expire(std::uint64_t now_ms);
+  [[nodiscard]] bool contains(std::uint32_t conn_id) const noexcept {
+    return ids_.contains(conn_id);
+  }
+  [[nodiscard]] std::size_t size() const noexcept { return ids_.size(); }
+
+ private:
+  struct Entry final {
+    std::uint32_t conn_id = 0;
+    std::uint64_t expires_at_ms = 0;
+  };
+
+  void pop_oldest();
+
+  std::uint64_t quiet_ms_ = 0;
+  std::size_t capacity_ = 0;
+  std::deque<Entry> by_expiry_;
+  std::unordered_set<std::uint32_t> ids_;
+};
+
 class ServerSessionManager final {
  public:
+  // A sharded server gives each shard's manager its own allocator so the
+  // conn_ids it hands out identify the shard (see ConnIdAllocator).
+  explicit ServerSessionManager(ConnIdAllocator conn_ids = ConnIdAllocator{});
+
   void on_datagram_received(const EndpointKey& endpoint,
                             std::span<const std::byte> bytes,
                             std::uint64_t now_ms);
 
+  // Polls at most one datagram from each session that has fresh input or a
+  // due timer. Idle sessions are not visited.
   [[nodiscard]] std::vector<OutboundDatagram> poll_tx(std::uint64_t now_ms);
+  // Same visiting rule as poll_tx(), but drains up to `budget_per_session`
+  // datagrams from each session into `sink` (appending to what it already
+  // holds). Returns how many datagrams were appended.
+  std::size_t poll_tx_batch(std::uint64_t now_ms,
+                            std::size_t budget_per_session,
+                            OutboundBatch& sink);
+  // Earliest time poll_tx() has work: `now_ms` while any session is marked
+  // ready, otherwise the next timer-wheel deadline.
+  [[nodiscard]] std::optional<std::uint64_t> next_deadline_ms(
+      std::uint64_t now_ms) const;
 
   [[nodiscard]] std::size_t pending_session_count() const noexcept {
     return pending_by_endpoint_.size();
@@ -53,6 +149,10 @@ class ServerSessionManager final {
     return active_by_conn_id_.size();
   }
 
+  [[nodiscard]] std::size_t retired_conn_id_count() const noexcept {
+    return retired_conn_ids_.size();
+  }
+
   [[nodiscard]] bool has_pending_session(const EndpointKey& endpoint) const
       noexcept;
   [[nodiscard]] bool has_active_session(std::uint32_t conn_id) const noexcept;
@@ -74,14 +174,20 @@ class ServerSessionManager final {
                                 std::uint32_t channel_id,
                                 Rudp::ChannelType channel_type,
                                 std::span<const std::byte> payload);
+  [[nodiscard]] bool queue_send(std::uint32_t conn_id,
+                                std::uint32_t channel_id,
+                                Rudp::ChannelType channel_type,
+                                std::vector<std::byte>&& payload);
 
  private:
+  // Both maps hold handles into sessions_; promotion moves the handle only.
   using PendingMap =
-      std::unordered_map<EndpointKey, Session, EndpointKeyHash>;
-  using ActiveMap = std::unordered_map<std::uint32_t, Session>;
+      std::unordered_map<EndpointKey, SessionSlab::Handle, EndpointKeyHash>;
+  using ActiveMap = std::unordered_map<std::uint32_t, SessionSlab::Handle>;
   using EndpointToConnIdMap =
       std::unordered_map<EndpointKey, std::uint32_t, EndpointKeyHash>;
   using ConnIdSet = std::unordered_set<std::uint32_t>;
+  using ConnIdToEndpointMap = std::unordered_map<std::uint32_t, EndpointKey>;
 
   [[nodiscard]] PendingMap::iterator find_pending_session(
       const EndpointKey& endpoint);
@@ -114,20 +220,32 @@ class ServerSessionManager final {
                                             std::uint64_t now_ms);
   [[nodiscard]] bool route_new_peer(const EndpointKey& endpoint,
                                     std::span<const std::byte> bytes,
-                                    const Rudp::Header& header,
+                                    const Rudp::PacketView& packet,
                                     std::uint64_t now_ms);
+  // Cookie mode: answers a SYN with a stateless SYN-ACK, and builds the
+  // session when a datagram echoes a cookie that verifies.
+  void reply_with_cookie(const EndpointKey& endpoint,
+                         const Rudp::PacketView& syn,
+                         std::uint64_t now_ms);
+  [[nodiscard]] bool route_cookie_echo(const EndpointKey& endpoint,
+                                       std::span<const std::byte> bytes,
+                                       const Rudp::PacketView& packet,
+                                       std::uint64_t now_ms);
   void cleanup_pending_if_terminal(const EndpointKey& endpoint,
                                    PendingMap::iterator pending_it);
   void cleanup_active_if_terminal(const EndpointKey& endpoint,
                                   std::uint32_t conn_id,
                                   ActiveMap::iterator active_it);
-  void collect_pending_tx(std::uint64_t now_ms,
-                          std::vector<OutboundDatagram>& outbound,
-                          std::vector<EndpointKey>& pending_to_cleanup);
-  void collect_active_tx(
-      std::uint64_t now_ms,
-      std::vector<OutboundDatagram>& outbound,
-      std::vector<std::pair<EndpointKey, std::uint32_t>>& active_to_cleanup);
+  [[nodiscard]] Session* find_session_by_conn_id(std::uint32_t conn_id,
+                                                 EndpointKey& endpoint);
+  [[nodiscard]] bool cleanup_if_terminal(std::uint32_t conn_id,
+                                         const EndpointKey& endpoint,
+                                         const Session& session);
+  void mark_ready(std::uint32_t conn_id);
+  [[nodiscard]] std::size_t poll_session(std::uint32_t conn_id,
+                                         std::uint64_t now_ms,
+                                         std::size_t budget,
+                                         OutboundBatch& sink);
   void promote_pending_session(const EndpointKey& endpoint,
                                PendingMap::iterator pending_it);
   void cleanup_pending_session(const EndpointKey& endpoint,
@@ -137,10 +255,27 @@ class ServerSessionManager final {
   [[nodiscard]] bool conn_id_is_in_use(std::uint32_t conn_id) const noexcept;
   [[nodiscard]] std::uint32_t allocate_conn_id();
 
+  ConnIdAllocator conn_ids_;
+  SessionSlab sessions_;
   PendingMap pending_by_endpoint_;
   ActiveMap active_by_conn_id_;
+  ConnIdToEndpointMap endpoint_by_conn_id_;
   EndpointToConnIdMap active_conn_id_by_endpoint_;
-  ConnIdSet retired_conn_ids_;
+  RetiredConnIds retired_conn_ids_;
+  // Time of the latest on_datagram_received() or poll_tx_batch() call, which
+  // is when sessions retire.
+  std::uint64_t now_ms_ = 0;
+  bool cookies_enabled_ = false;
+  HandshakeCookies cookies_;
+  // Cookie SYN-ACKs waiting for the next poll_tx_batch(); they belong to no
+  // session.
+  OutboundBatch cookie_replies_;
+  // Sessions are keyed by conn_id in both structures below; pending sessions
+  // get their conn_id on creation, so one key space covers both maps.
+  TimerWheel timers_;
+  std::vector<std::uint32_t> ready_;
+  ConnIdSet ready_set_;
+  std::vector<std::uint32_t> polling_;
 };
 
 }  // namespace Rudp::Session
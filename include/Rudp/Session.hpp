@@ -6,11 +6,17 @@
 
 #include "Rudp/Codec.hpp"
 #include "Rudp/ConnectionStateMachine.hpp"
+#include "Rudp/DatagramArena.hpp"
 #include "Rudp/RxHandler.hpp"
 #include "Rudp/TxHandler.hpp"
 
 namespace Rudp::Session {
 
+// WINDOW and FEATURES TLVs a server's SYN-ACK carries in reply to a SYN
+// with `syn_extensions`, from the current transport settings.
+[[nodiscard]] Rudp::HeaderExtensions syn_ack_extensions(
+    const Rudp::HeaderExtensions& syn_extensions);
+
 class Session final {
  public:
   explicit Session(SessionRole role = SessionRole::Client);
@@ -19,13 +25,51 @@ class Session final {
   void queue_send(std::uint32_t channel_id,
                   Rudp::ChannelType channel_type,
                   std::span<const std::byte> payload);
+  // Takes ownership of `payload`, so it is only copied once more: into the
+  // datagram that carries it.
+  void queue_send(std::uint32_t channel_id,
+                  Rudp::ChannelType channel_type,
+                  std::vector<std::byte>&& payload);
 
   [[nodiscard]] std::optional<std::vector<std::byte>> poll_tx(
       std::uint64_t now_ms);
 
+  // Writes the next datagram into `buffer` and returns its size, or nullopt
+  // when there is nothing to send. A datagram that does not fit is left
+  // queued; a buffer of max_datagram_size() bytes always suffices.
+  [[nodiscard]] std::optional<std::size_t> poll_tx_into(
+      std::span<std::byte> buffer,
+      std::uint64_t now_ms);
+
+  // Appends up to `budget` datagrams to `sink` in one pass and returns how
+  // many were added. Fewer than `budget` means the session has nothing more
+  // to send right now (empty queues, a full window or the pacer).
+  std::size_t poll_tx_batch(std::uint64_t now_ms,
+                            std::size_t budget,
+                            DatagramArena& sink);
+
+  // Largest datagram poll_tx_into() can produce for the data queued so far:
+  // the maximum header with extensions plus the largest queued payload, or
+  // the negotiated bundle budget when that is larger.
+  [[nodiscard]] std::size_t max_datagram_size() const noexcept;
+
   void on_datagram_received(std::span<const std::byte> bytes,
                             std::uint64_t now_ms);
 
+  // Earliest time at which poll_tx() has work (a queued packet, RTO, delayed
+  // ACK, keepalive or idle timeout). Returns `now_ms` when poll_tx() should be
+  // called right away and nullopt when the session waits only on new input.
+  [[nodiscard]] std::optional<std::uint64_t> next_deadline_ms(
+      std::uint64_t now_ms) const;
+
+  // Server side of a cookie handshake (Protocol.md §7.4). Leaves a session
+  // built with the SYN-ACK's seq as `initial_seq` where `syn`, that SYN-ACK
+  // and the client's final ACK would have: Established, with a Connected
+  // event queued. The caller then delivers the datagram that echoed the
+  // cookie as usual.
+  void resume_handshake(const Rudp::PacketView& syn,
+                        const Rudp::HeaderExtensions& syn_extensions,
+                        std::uint64_t now_ms);
   void request_close();
   void assign_conn_id(std::uint32_t conn_id) noexcept { state_.conn_id = conn_id; }
 
@@ -46,6 +90,10 @@ class Session final {
  private:
   void apply_connection_decision(const Rudp::PacketView& packet,
                                  const ConnectionDecision& decision);
+  // Shared by poll_tx() and poll_tx_into(): idle timeout and timer-driven
+  // work before polling, fatal-error handling after.
+  [[nodiscard]] bool prepare_poll(std::uint64_t now_ms);
+  [[nodiscard]] bool finish_poll(TxPollResult& result);
 
   SessionState state_;
   TxHandler tx_handler_;
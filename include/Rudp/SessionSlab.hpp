@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "Rudp/Session.hpp"
+
+namespace Rudp::Session {
+
+// Owns the server's sessions so the lookup maps can hold 4-byte handles
+// instead of whole Session values. Slots live in fixed chunks of
+// kChunkSlots, each slot on its own cache line, and are allocated a chunk at
+// a time. A session keeps its handle and address from emplace() to erase(),
+// so moving it between maps is a handle copy. Freed slots go on a LIFO free
+// list and are reused before any new chunk is allocated.
+class SessionSlab final {
+ public:
+  using Handle = std::uint32_t;
+
+  static constexpr std::size_t kChunkSlots = 64;
+
+  template <typename... Args>
+  [[nodiscard]] Handle emplace(Args&&... args) {
+    const auto handle = acquire_slot();
+    slot(handle).session.emplace(std::forward<Args>(args)...);
+    ++size_;
+    return handle;
+  }
+  void erase(Handle handle) noexcept;
+
+  [[nodiscard]] Session& operator[](Handle handle) noexcept {
+    return *slot(handle).session;
+  }
+  [[nodiscard]] const Session& operator[](Handle handle) const noexcept {
+    return *slot(handle).session;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+  [[nodiscard]] std::size_t capacity() const noexcept {
+    return chunks_.size() * kChunkSlots;
+  }
+
+ private:
+  static constexpr Handle kNoSlot = std::numeric_limits<Handle>::max();
+
+  struct alignas(64) Slot final {
+    std::optional<Session> session;
+    Handle next_free = kNoSlot;
+  };
+  using Chunk = std::array<Slot, kChunkSlots>;
+
+  [[nodiscard]] Handle acquire_slot();
+  [[nodiscard]] Slot& slot(Handle handle) noexcept {
+    return (*chunks_[handle / kChunkSlots])[handle % kChunkSlots];
+  }
+  [[nodiscard]] const Slot& slot(Handle handle) const noexcept {
+    return (*chunks_[handle / kChunkSlots])[handle % kChunkSlots];
+  }
+
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  Handle free_head_ = kNoSlot;
+  std::size_t size_ = 0;
+};
+
+}  // namespace Rudp::Session
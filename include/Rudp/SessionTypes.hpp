@@ -3,13 +3,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <deque>
-#include <map>
 #include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "Rudp/CongestionControl.hpp"
+#include "Rudp/Pacer.hpp"
 #include "Rudp/Protocol.hpp"
+#include "Rudp/SeqRing.hpp"
 
 namespace Rudp::Session {
 
@@ -27,6 +29,18 @@ enum class ConnectionState : std::uint8_t {
   Reset = 5,
 };
 
+enum class ControlKind : std::uint8_t {
+  None = 0,
+  Syn = 1,
+  SynAck = 2,
+  Ack = 3,
+  Fin = 4,
+  Rst = 5,
+  Ping = 6,
+  Pong = 7,
+  Invalid = 8,
+};
+
 struct OwnedPacket final {
   Rudp::Header header;
   std::vector<std::byte> payload;
@@ -39,12 +53,17 @@ struct SendRequest final {
 };
 
 struct TxEntry final {
+  // The packet as last sent. The payload is moved in from the send queue, and
+  // a retransmission encodes it straight into the outbound datagram.
   OwnedPacket packet;
   std::uint64_t first_send_ms = 0;
   std::uint64_t last_send_ms = 0;
   std::uint32_t retry_count = 0;
   std::uint32_t gap_evidence_count = 0;
   bool fast_retx_pending = false;
+  DeliveryStamp delivery;
+  // STREAM_SEQ the packet was sent with, re-sent unchanged on retransmit.
+  std::optional<std::uint32_t> stream_seq;
 };
 
 struct SessionEvent final {
@@ -86,14 +105,26 @@ struct SessionStats final {
 };
 
 struct TxPollResult final {
+  // Filled by TxHandler::poll(); poll_into() writes to the caller's buffer.
   std::optional<std::vector<std::byte>> datagram;
+  // Bytes poll_into() wrote, 0 when nothing was sent.
+  std::size_t written = 0;
+  // Non-zero when poll_into()'s buffer was too small for the next datagram;
+  // nothing was consumed and a buffer of this size will do.
+  std::size_t required_size = 0;
   bool fatal_error = false;
   bool retransmission = false;
   std::string error_message;
+  // Describe the datagram that was built, so callers never re-decode it.
+  Rudp::Header header{};
+  ControlKind control_kind = ControlKind::None;
+  std::size_t payload_size = 0;
 };
 
 struct TxAckResult final {
   bool acknowledged_fin = false;
+  // Freshest RTT among newly acknowledged never-retransmitted packets.
+  std::optional<std::uint64_t> rtt_sample_ms;
 };
 
 struct RxPacketResult final {
@@ -108,12 +139,69 @@ struct ProbeTxState final {
   std::uint64_t last_ping_sent_ms = 0;
 };
 
+// RFC 6298 estimator. SRTT/RTTVAR are kept in microseconds so millisecond
+// samples on a fast LAN still move them; rto_ms is 0 until the first sample.
+struct RttEstimate final {
+  std::uint64_t srtt_us = 0;
+  std::uint64_t rttvar_us = 0;
+  std::uint64_t rto_ms = 0;
+};
+
+// App data queued on one channel. Queues of the best priority with sendable
+// data share the link by deficit round-robin: `deficit` is the queue's credit
+// in payload bytes, topped up by weight * max_datagram_bytes each time the
+// turn reaches it.
+struct ChannelQueue final {
+  std::uint32_t channel_id = 0;
+  std::uint8_t priority = 0;
+  std::uint32_t weight = 1;
+  std::int64_t deficit = 0;
+  std::deque<SendRequest> pending;
+  // Bytes of pending.front() already sent as fragments, and the seq of its
+  // first fragment.
+  std::size_t front_fragment_offset = 0;
+  std::uint32_t front_fragment_first_seq = 0;
+};
+
 struct TxSessionState final {
   std::uint32_t next_seq = 0;
   std::uint32_t remote_ack = 0;
   std::uint64_t remote_ack_bits = 0;
-  std::deque<SendRequest> pending_send;
-  std::map<std::uint32_t, TxEntry> inflight;
+  // Negotiated limit on next_seq - remote_ack.
+  std::uint32_t send_window =
+      static_cast<std::uint32_t>(Rudp::kReliableWindowSize);
+  // Send a Window TLV on SYN / SYN-ACK. Only set once the peer is known (or,
+  // for a client, configured) to understand header extensions.
+  bool advertise_window = false;
+  // FEATURES bits this side offers, sent on SYN / SYN-ACK under the same rule
+  // as the Window TLV.
+  std::uint32_t local_features = 0;
+  bool advertise_features = false;
+  // Client only: the cookie of a server's SYN-ACK, echoed on every packet
+  // until anything else arrives from the server, which shows the server has
+  // built its side of the session.
+  std::optional<Rudp::HandshakeCookie> handshake_cookie;
+  // Datagram budget for bundling queued messages; 0 until both peers agreed
+  // to kFeatureBundle during the handshake.
+  std::size_t bundle_max_datagram_bytes = 0;
+  // Message bytes per fragment once both peers agreed to kFeatureFragment;
+  // 0 means reliable messages always go out whole.
+  std::size_t fragment_slice_size = 0;
+  // Set once both peers agreed to kFeatureOrderedStreams. ReliableOrdered
+  // packets then carry the next per-channel STREAM_SEQ, starting at 0.
+  bool ordered_streams_agreed = false;
+  std::unordered_map<std::uint32_t, std::uint32_t> next_stream_seq;
+  // Queued app data, one FIFO per channel, sorted by (priority, channel_id).
+  // send_turn indexes the queue holding the round-robin turn, and
+  // send_turn_credited says whether it got its quantum for this turn.
+  std::vector<ChannelQueue> send_queues;
+  std::size_t send_turn = 0;
+  bool send_turn_credited = false;
+  // Requests across all send_queues.
+  std::size_t pending_send_count = 0;
+  // Largest payload ever queued; sizes caller buffers for poll_tx_into().
+  std::size_t max_payload_size = 0;
+  SeqRing<TxEntry> inflight;
   bool syn_ack_pending = false;
   bool final_ack_pending = false;
   std::uint64_t final_ack_linger_until_ms = 0;
@@ -123,15 +211,53 @@ struct TxSessionState final {
   std::uint64_t reliable_ack_due_ms = 0;
   bool activity_ack_pending = false;
   ProbeTxState probe;
+  RttEstimate rtt;
+  CongestionController congestion;
+  Pacer pacer;
+};
+
+// A fragmented message being put back together. `payload` is allocated at
+// its full size when the first fragment arrives.
+struct Reassembly final {
+  std::uint32_t channel_id = 0;
+  Rudp::ChannelType channel_type = Rudp::ChannelType::ReliableOrdered;
+  std::uint16_t fragment_count = 0;
+  std::uint16_t received_count = 0;
+  std::vector<std::byte> payload;
+};
+
+// Delivery state of one ReliableOrdered channel whose packets carry a
+// STREAM_SEQ. The buffer is keyed by stream seq and only holds packets that
+// arrived early, so an idle or in-order channel costs no per-packet memory
+// and the total across channels stays within the receive window.
+struct OrderedStream final {
+  std::unordered_map<std::uint32_t, OwnedPacket> reorder_buffer;
+  std::uint32_t next_delivery = 0;
 };
 
 struct RxSessionState final {
   std::uint32_t next_expected = 0;
   std::uint64_t received_bits = 0;
-  std::map<std::uint32_t, OwnedPacket> ordered_reorder_buffer;
+  // Local reliable window; seqs up to next_expected + receive_window are
+  // accepted. Those past the AckBits bitmap are tracked here and reported
+  // as SACK ranges.
+  std::uint32_t receive_window =
+      static_cast<std::uint32_t>(Rudp::kReliableWindowSize);
+  SeqBitset received_beyond;
+  // ReliableOrdered packets without a STREAM_SEQ share one session-wide
+  // order: a packet is delivered once every earlier seq has arrived.
+  // Buffered seqs span at most next_expected..next_expected + receive_window.
+  SeqRing<OwnedPacket> ordered_reorder_buffer{Rudp::kReliableWindowSize + 1U};
   std::uint32_t next_ordered_delivery = 0;
   bool ordered_delivery_started = false;
+  // Per-channel ordering for packets that carry a STREAM_SEQ.
+  std::unordered_map<std::uint32_t, OrderedStream> ordered_streams;
   std::unordered_map<std::uint32_t, std::uint32_t> monotonic_versions;
+  // Keyed by the seq of the message's first fragment. reassembly_bytes sums
+  // the payload sizes and stays within max_reassembly_bytes.
+  std::unordered_map<std::uint32_t, Reassembly> reassembly;
+  std::size_t reassembly_bytes = 0;
+  std::size_t max_reassembly_bytes = 0;
   std::vector<SessionEvent> pending_events;
 };
 
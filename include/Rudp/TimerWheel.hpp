@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Rudp::Session {
+
+// Hierarchical timing wheel holding at most one deadline per id (conn_id).
+// Four levels of 64 one-millisecond-based slots cover ~4.6 hours; later
+// deadlines are parked in the top level and re-cascaded until in range.
+//
+// Cancellation is lazy: `deadlines_` is authoritative and slot entries whose
+// deadline no longer matches it are discarded when their slot is reached.
+// schedule(), cancel() and each expiry are O(1); advance() skips runs of
+// empty slots using per-level occupancy bitmaps.
+class TimerWheel final {
+ public:
+  explicit TimerWheel(std::uint64_t now_ms = 0) noexcept : current_ms_(now_ms) {}
+
+  // Sets (or replaces) the deadline for `id`. A deadline at or before the
+  // wheel's current time expires on the next advance().
+  void schedule(std::uint32_t id, std::uint64_t deadline_ms);
+  void cancel(std::uint32_t id);
+
+  // Moves the wheel to `now_ms` and appends every id whose deadline has been
+  // reached to `expired`, removing it from the wheel.
+  void advance(std::uint64_t now_ms, std::vector<std::uint32_t>& expired);
+
+  // Earliest time advance() may expire something. This can be earlier than
+  // the true next deadline (a cascade point or a cancelled entry), never
+  // later.
+  [[nodiscard]] std::optional<std::uint64_t> next_deadline_ms() const noexcept;
+
+  [[nodiscard]] std::optional<std::uint64_t> deadline_of(
+      std::uint32_t id) const noexcept;
+  [[nodiscard]] std::size_t size() const noexcept { return deadlines_.size(); }
+  [[nodiscard]] bool empty() const noexcept { return deadlines_.empty(); }
+  [[nodiscard]] std::uint64_t current_ms() const noexcept { return current_ms_; }
+
+ private:
+  static constexpr std::size_t kLevels = 4;
+  static constexpr unsigned kSlotBits = 6;
+  static constexpr std::size_t kSlotsPerLevel = std::size_t{1} << kSlotBits;
+
+  struct Entry final {
+    std::uint32_t id = 0;
+    std::uint64_t deadline_ms = 0;
+  };
+
+  using Slot = std::vector<Entry>;
+
+  void place(const Entry& entry);
+  void cascade(std::size_t level);
+  void expire_slot(std::size_t slot_index, std::vector<std::uint32_t>& expired);
+  void collect_due(std::vector<std::uint32_t>& expired);
+  [[nodiscard]] bool is_live(const Entry& entry) const noexcept;
+
+  std::uint64_t current_ms_ = 0;
+  std::array<std::array<Slot, kSlotsPerLevel>, kLevels> levels_{};
+  std::array<std::uint64_t, kLevels> occupied_{};
+  std::vector<Entry> due_;
+  std::unordered_map<std::uint32_t, std::uint64_t> deadlines_;
+};
+
+}  // namespace Rudp::Session
@@ -9,17 +9,38 @@
 
 namespace Rudp::Session {
 
+class DatagramOutput;
+
 class TxHandler final {
  public:
   void queue_app_data(std::uint32_t channel_id,
                       Rudp::ChannelType channel_type,
                       std::span<const std::byte> payload,
                       TxSessionState& tx);
+  // Takes ownership of `payload`; it is next copied when it is encoded into
+  // an outbound datagram.
+  void queue_app_data(std::uint32_t channel_id,
+                      Rudp::ChannelType channel_type,
+                      std::vector<std::byte>&& payload,
+                      TxSessionState& tx);
 
+  // Releases acknowledged inflight packets and, following Karn's rule, feeds
+  // the RTT of any that were never retransmitted into the RTO estimator.
   [[nodiscard]] TxAckResult on_remote_ack(std::uint32_t ack,
                                           std::uint64_t ack_bits,
+                                          std::uint64_t now_ms,
                                           TxSessionState& tx);
 
+  // Also releases inflight seqs covered by `sack_ranges` and counts them as
+  // gap evidence for older unacknowledged packets.
+  [[nodiscard]] TxAckResult on_remote_ack(
+      std::uint32_t ack,
+      std::uint64_t ack_bits,
+      std::span<const Rudp::SackRange> sack_ranges,
+      std::uint64_t now_ms,
+      TxSessionState& tx);
+
+  // Builds the next datagram into a vector sized to fit.
   [[nodiscard]] TxPollResult poll(std::uint64_t now_ms,
                                   SessionRole role,
                                   std::uint32_t conn_id,
@@ -27,47 +48,95 @@ class TxHandler final {
                                   const RxSessionState& rx,
                                   TxSessionState& tx);
 
- private:
-  [[nodiscard]] std::optional<std::vector<std::byte>> try_build_handshake(
+  // Same as poll(), but encodes straight into `buffer` and reports the size
+  // in `written`. If the next datagram is larger than `buffer`, nothing is
+  // consumed and `required_size` says how much room it needs.
+  [[nodiscard]] TxPollResult poll_into(std::span<std::byte> buffer,
+                                       std::uint64_t now_ms,
+                                       SessionRole role,
+                                       std::uint32_t conn_id,
+                                       ConnectionState& connection_state,
+                                       const RxSessionState& rx,
+                                       TxSessionState& tx);
+
+  // Earliest time poll() will have something to emit: `now_ms` when work is
+  // already queued, the next retransmission timeout otherwise, or nullopt
+  // when only new input (app data, a received ACK) can create work.
+  [[nodiscard]] std::optional<std::uint64_t> next_deadline_ms(
       std::uint64_t now_ms,
       SessionRole role,
-      std::uint32_t conn_id,
-      ConnectionState& connection_state,
-      const RxSessionState& rx,
-      TxSessionState& tx);
+      ConnectionState connection_state,
+      const TxSessionState& tx) const;
+
+ private:
+  [[nodiscard]] TxPollResult poll_output(DatagramOutput& output,
+                                         std::uint64_t now_ms,
+                                         SessionRole role,
+                                         std::uint32_t conn_id,
+                                         ConnectionState& connection_state,
+                                         const RxSessionState& rx,
+                                         TxSessionState& tx);
 
-  [[nodiscard]] TxPollResult try_build_retransmit(std::uint64_t now_ms,
+  [[nodiscard]] bool try_build_handshake(DatagramOutput& output,
+                                         std::uint64_t now_ms,
+                                         SessionRole role,
+                                         std::uint32_t conn_id,
+                                         ConnectionState& connection_state,
+                                         const RxSessionState& rx,
+                                         TxSessionState& tx);
+
+  [[nodiscard]] TxPollResult try_build_retransmit(DatagramOutput& output,
+                                                  std::uint64_t now_ms,
                                                   const RxSessionState& rx,
                                                   TxSessionState& tx);
 
-  [[nodiscard]] std::optional<std::vector<std::byte>> try_build_ack_only(
-      std::uint32_t conn_id,
-      const RxSessionState& rx,
-      TxSessionState& tx);
+  [[nodiscard]] bool try_build_ack_only(DatagramOutput& output,
+                                        std::uint32_t conn_id,
+                                        const RxSessionState& rx,
+                                        TxSessionState& tx);
 
-  [[nodiscard]] std::optional<std::vector<std::byte>> try_build_probe_lane(
-      std::uint32_t conn_id,
-      const RxSessionState& rx,
-      TxSessionState& tx);
+  [[nodiscard]] bool try_build_probe_lane(DatagramOutput& output,
+                                          std::uint32_t conn_id,
+                                          const RxSessionState& rx,
+                                          TxSessionState& tx);
 
-  [[nodiscard]] std::optional<std::vector<std::byte>> try_build_fresh(
-      std::uint64_t now_ms,
-      std::uint32_t conn_id,
-      const RxSessionState& rx,
-      TxSessionState& tx);
+  [[nodiscard]] bool try_build_fresh(DatagramOutput& output,
+                                     std::uint64_t now_ms,
+                                     std::uint32_t conn_id,
+                                     const RxSessionState& rx,
+                                     TxSessionState& tx);
 
-  [[nodiscard]] OwnedPacket make_packet_from_request(const SendRequest& req,
-                                                     std::uint32_t conn_id,
-                                                     const RxSessionState& rx,
-                                                     TxSessionState& tx,
-                                                     bool assign_reliable_seq);
+  // Writes the next fragment of queue.pending.front(), the packet with `seq`,
+  // into payload_scratch_ and returns how many message bytes it carries, or 0
+  // when the request is sent whole.
+  [[nodiscard]] std::size_t gather_fragment(ChannelQueue& queue,
+                                            std::uint32_t seq,
+                                            const TxSessionState& tx);
 
-  [[nodiscard]] std::optional<std::vector<std::byte>> build_control_packet(
-      std::uint64_t now_ms,
-      std::uint32_t conn_id,
-      Rudp::Flags flags,
-      const RxSessionState& rx,
-      TxSessionState& tx);
+  // Packs the run of queued messages that can share one BUNDLE datagram
+  // into payload_scratch_ and returns how many it took. Bundling is only worth
+  // it for two or more; callers fall back to the front request otherwise.
+  [[nodiscard]] std::size_t gather_bundle(
+      const Rudp::HeaderExtensions& extensions,
+      const ChannelQueue& queue,
+      const TxSessionState& tx);
+
+  [[nodiscard]] Header make_header_from_request(const SendRequest& req,
+                                                std::uint32_t conn_id,
+                                                const RxSessionState& rx,
+                                                const TxSessionState& tx,
+                                                bool assign_reliable_seq) const;
+
+  [[nodiscard]] bool build_control_packet(DatagramOutput& output,
+                                          std::uint64_t now_ms,
+                                          std::uint32_t conn_id,
+                                          Rudp::Flags flags,
+                                          const RxSessionState& rx,
+                                          TxSessionState& tx);
+
+  // Reused across polls so bundles and fragments do not allocate per
+  // datagram.
+  std::vector<std::byte> payload_scratch_;
 };
 
 }  // namespace Rudp::Session
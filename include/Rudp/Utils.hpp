@@ -10,12 +10,18 @@
 
 namespace Rudp::Utils {
 
+[[nodiscard]] std::uint16_t readU16(std::span<const std::byte> bytes,
+                                    std::size_t offset) noexcept;
+
 [[nodiscard]] std::uint32_t readU32(std::span<const std::byte> bytes,
                                     std::size_t offset) noexcept;
 
 [[nodiscard]] std::uint64_t readU64(std::span<const std::byte> bytes,
                                     std::size_t offset) noexcept;
 
+void writeU16(std::span<std::byte> bytes, std::size_t offset,
+              std::uint16_t value) noexcept;
+
 void writeU32(std::span<std::byte> bytes, std::size_t offset,
               std::uint32_t value) noexcept;
 
@@ -1,9 +1,9 @@
 #include "Rudp/BsdClientApp.hpp"
 
-#include <sys/select.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cerrno>
 #include <chrono>
@@ -25,6 +25,7 @@
 
 #include "Rudp/BsdUdpSocket.hpp"
 #include "Rudp/Config.hpp"
+#include "Rudp/EpollReactor.hpp"
 #include "Rudp/Session.hpp"
 #include "Rudp/Utils.hpp"
 
@@ -133,7 +134,7 @@ parse_client_send_command(const Rudp::Config::RuntimeProfile& profile,
 struct QueuedSend final {
   std::uint32_t channel_id = 0;
   Rudp::ChannelType channel_type = Rudp::ChannelType::Unreliable;
-  std::string payload;
+  std::vector<std::byte> payload;
 };
 
 struct SpawnCommand final {
@@ -146,7 +147,8 @@ struct SpawnCommand final {
 
 class LoadGenerator final {
  public:
-  LoadGenerator() = default;
+  // Workers notify `reactor` after each enqueue so the loop drains promptly.
+  explicit LoadGenerator(const EpollReactor& reactor) : reactor_(reactor) {}
 
   ~LoadGenerator() { stop_all(); }
 
@@ -170,15 +172,20 @@ class LoadGenerator final {
             break;
           }
 
+          // Built off the event loop, which then moves it into the session.
+          const auto text = payload + " [t" + std::to_string(worker_index) +
+                            " #" + std::to_string(produced) + ']';
+          const auto* first = reinterpret_cast<const std::byte*>(text.data());
+          std::vector<std::byte> message(first, first + text.size());
           {
             std::scoped_lock lock(queue_mutex_);
             queue_.push_back(QueuedSend{
                 .channel_id = channel_id,
                 .channel_type = channel_type,
-                .payload = payload + " [t" + std::to_string(worker_index) +
-                           " #" + std::to_string(produced) + ']',
+                .payload = std::move(message),
             });
           }
+          reactor_.notify();
 
           ++produced;
           if (interval_ms == 0) {
@@ -230,6 +237,7 @@ class LoadGenerator final {
   mutable std::mutex queue_mutex_;
   std::deque<QueuedSend> queue_;
   std::vector<std::thread> workers_;
+  const EpollReactor& reactor_;
 };
 
 [[nodiscard]] std::optional<SpawnCommand> parse_spawn_command(
@@ -376,10 +384,37 @@ void run_client_app(const Rudp::Config::RuntimeProfile& profile,
   if (!socket->bind(profile.bind_address, profile.bind_port)) {
     return;
   }
+  if (profile.enable_gso && !socket->enable_gso()) {
+    log_line(logger, "[client] UDP GSO unavailable; sending one datagram per message");
+  }
+  if (profile.enable_gro && !socket->enable_gro()) {
+    log_line(logger, "[client] UDP GRO unavailable; receiving one datagram per slot");
+  }
+  if (profile.max_pacing_rate_bytes != 0 &&
+      !socket->set_max_pacing_rate(profile.max_pacing_rate_bytes)) {
+    log_line(logger, "[client] SO_MAX_PACING_RATE unavailable; relying on session pacing");
+  }
 
-  const EndpointKey server_endpoint{profile.remote_address, profile.remote_port};
+  const auto resolved_server =
+      resolve_endpoint(profile.remote_address, profile.remote_port);
+  if (!resolved_server.has_value()) {
+    log_line(logger, "[client] cannot resolve remote address " +
+                         profile.remote_address);
+    return;
+  }
+  const EndpointKey server_endpoint = *resolved_server;
   Session session(SessionRole::Client);
-  LoadGenerator load_generator;
+  auto receive_slots = make_receive_slots(
+      std::clamp<std::size_t>(profile.io_batch_size, 1U, kMaxDatagramBatch),
+      socket->gro_enabled()
+          ? std::max<std::size_t>(profile.socket_buffer_size, kMaxGroBufferSize)
+          : profile.socket_buffer_size);
+  TxBacklog tx_backlog;
+  auto reactor = EpollReactor::create();
+  if (!reactor.has_value()) {
+    return;
+  }
+  LoadGenerator load_generator(*reactor);
   const auto bootstrap_commands = load_bootstrap_commands(logger);
   bool bootstrap_applied = bootstrap_commands.empty();
   bool stdin_enabled = ::isatty(STDIN_FILENO) != 0;
@@ -393,6 +428,17 @@ void run_client_app(const Rudp::Config::RuntimeProfile& profile,
              "[client] stdin is not interactive; runtime commands disabled");
   }
 
+  const int socket_fd = socket->native_handle();
+  bool watching_writable = false;
+  if (!reactor->watch(socket_fd, true, watching_writable)) {
+    return;
+  }
+  if (stdin_enabled && !reactor->watch(STDIN_FILENO, true, false)) {
+    stdin_enabled = false;
+  }
+
+  std::array<ReadyFd, 4> ready{};
+  std::optional<std::uint64_t> wake_at_ms = now_ms();
   bool should_exit = false;
   while (!should_exit) {
     if (g_stop_requested.load()) {
@@ -400,36 +446,41 @@ void run_client_app(const Rudp::Config::RuntimeProfile& profile,
       break;
     }
 
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(socket->native_handle(), &readfds);
-    int max_fd = socket->native_handle();
-    if (stdin_enabled) {
-      FD_SET(STDIN_FILENO, &readfds);
-      max_fd = std::max(max_fd, STDIN_FILENO);
+    const bool want_writable = !tx_backlog.empty();
+    if (want_writable != watching_writable) {
+      if (!reactor->watch(socket_fd, true, want_writable)) {
+        break;
+      }
+      watching_writable = want_writable;
     }
 
-    timeval timeout{};
-    timeout.tv_sec = 0;
-    timeout.tv_usec = static_cast<suseconds_t>(
-        profile.select_timeout_us);
-    const int ready = ::select(max_fd + 1, &readfds, nullptr, nullptr, &timeout);
-    if (ready < 0 && errno != EINTR) {
-      std::perror("select");
+    const auto ready_count = reactor->wait(wake_at_ms, ready);
+    if (!ready_count.has_value()) {
       break;
     }
-
-    if (FD_ISSET(socket->native_handle(), &readfds)) {
-      while (const auto received = socket->recv_from(
-                 profile.socket_buffer_size)) {
-        session.on_datagram_received(received->bytes, now_ms());
+    const std::span<const ReadyFd> ready_fds(ready.data(), *ready_count);
+
+    if (const auto* entry = find_ready(ready_fds, socket_fd);
+        entry != nullptr && entry->readable) {
+      for (;;) {
+        const auto received = socket->recv_batch(receive_slots);
+        const auto received_at_ms = now_ms();
+        for (std::size_t i = 0; i < received; ++i) {
+          for_each_datagram(receive_slots[i], [&](auto bytes) {
+            session.on_datagram_received(bytes, received_at_ms);
+          });
+        }
+        if (received < receive_slots.size()) {
+          break;
+        }
       }
     }
 
-    if (stdin_enabled && FD_ISSET(STDIN_FILENO, &readfds)) {
+    if (stdin_enabled && find_ready(ready_fds, STDIN_FILENO) != nullptr) {
       std::string line;
       if (!std::getline(std::cin, line)) {
         stdin_enabled = false;
+        static_cast<void>(reactor->unwatch(STDIN_FILENO));
       } else {
         static_cast<void>(process_client_command(profile, session, load_generator,
                                                  logger, line,
@@ -441,20 +492,21 @@ void run_client_app(const Rudp::Config::RuntimeProfile& profile,
     }
 
     for (auto& generated : load_generator.drain()) {
-      const auto* first =
-          reinterpret_cast<const std::byte*>(generated.payload.data());
       session.queue_send(generated.channel_id, generated.channel_type,
-                         std::span<const std::byte>(first,
-                                                    generated.payload.size()));
+                         std::move(generated.payload));
     }
 
-    for (std::uint32_t i = 0;
-         i < profile.poll_budget; ++i) {
-      auto outbound = session.poll_tx(now_ms());
-      if (!outbound.has_value()) {
-        break;
-      }
-      static_cast<void>(socket->send_to(server_endpoint, *outbound));
+    const auto polled_at_ms = now_ms();
+    flush_backlog(*socket, tx_backlog);
+    bool tx_stalled = !tx_backlog.empty();
+    if (!tx_stalled) {
+      auto& batch = tx_backlog.batch;
+      const auto produced = session.poll_tx_batch(
+          polled_at_ms, profile.poll_budget, batch.datagrams);
+      batch.endpoints.resize(batch.endpoints.size() + produced,
+                             server_endpoint);
+      tx_stalled = produced < profile.poll_budget;
+      flush_backlog(*socket, tx_backlog);
     }
 
     drain_client_events(session, logger);
@@ -474,6 +526,8 @@ void run_client_app(const Rudp::Config::RuntimeProfile& profile,
       log_line(logger, "[client] session entered Reset, exiting");
       should_exit = true;
     }
+    wake_at_ms = reactor_deadline_ms(session.next_deadline_ms(polled_at_ms),
+                                     polled_at_ms, tx_stalled);
   }
 
   log_line(logger, format_session_summary("[client]", session.stats()));
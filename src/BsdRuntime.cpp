@@ -121,6 +121,22 @@ int run_cli(int argc, char** argv) {
   }
   apply_connection_overrides(profile);
   apply_log_path_override(profile);
+  // Sessions read transport settings globally; the profile's choice wins.
+  auto& transport = Rudp::Config::mutable_current().transport;
+  transport.congestion_control = profile.congestion_control;
+  transport.enable_pacing = profile.enable_pacing;
+  transport.enable_bundling = profile.enable_bundling;
+  transport.enable_fragmentation = profile.enable_fragmentation;
+  transport.enable_ordered_streams = profile.enable_ordered_streams;
+  transport.enable_handshake_cookies = profile.enable_handshake_cookies;
+  transport.channel_schedules.clear();
+  for (const auto& channel : profile.channels) {
+    transport.channel_schedules.push_back(Rudp::Config::ChannelSchedule{
+        .channel_id = channel.id,
+        .priority = channel.priority,
+        .weight = channel.weight,
+    });
+  }
 
   const auto logger = make_runtime_logger(profile);
   if (profile.mode == Rudp::Config::RuntimeMode::Server) {
@@ -1,9 +1,9 @@
 #include "Rudp/BsdServerApp.hpp"
 
-#include <sys/select.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cerrno>
 #include <chrono>
@@ -16,11 +16,14 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "Rudp/BsdUdpSocket.hpp"
 #include "Rudp/Config.hpp"
+#include "Rudp/EpollReactor.hpp"
 #include "Rudp/ServerSessionManager.hpp"
 #include "Rudp/Utils.hpp"
 
@@ -53,8 +56,7 @@ void drain_server_events(
     std::optional<std::uint32_t>& preferred_conn_id,
     std::unordered_map<std::uint32_t, EndpointKey>& active_endpoints) {
   for (const auto& wrapped : manager.drain_events()) {
-    std::string prefix = "[server] endpoint=" + wrapped.endpoint.address + ':' +
-                         std::to_string(wrapped.endpoint.port);
+    std::string prefix = "[server] endpoint=" + wrapped.endpoint.to_string();
     if (wrapped.conn_id.has_value()) {
       prefix += " conn_id=" + std::to_string(*wrapped.conn_id);
       preferred_conn_id = wrapped.conn_id;
@@ -141,9 +143,8 @@ void log_server_summaries(
       continue;
     }
 
-    std::string prefix = "[server] endpoint=" + endpoint.address + ':' +
-                         std::to_string(endpoint.port) + " conn_id=" +
-                         std::to_string(conn_id);
+    std::string prefix = "[server] endpoint=" + endpoint.to_string() +
+                         " conn_id=" + std::to_string(conn_id);
     log_line(logger, format_session_summary(prefix, *stats));
   }
 }
@@ -224,8 +225,7 @@ void handle_server_stdin(
     } else {
       for (const auto& [conn_id, endpoint] : active_endpoints) {
         log_line(logger, "[server] active conn_id=" + std::to_string(conn_id) +
-                             " endpoint=" + endpoint.address + ':' +
-                             std::to_string(endpoint.port));
+                             " endpoint=" + endpoint.to_string());
       }
     }
     return;
@@ -254,34 +254,108 @@ void handle_server_stdin(
   }
 }
 
-}  // namespace
+// One worker's share of the server: its own socket in the SO_REUSEPORT group
+// and its own reactor. The session manager lives on the worker's stack, so
+// shards share no transport state. Shard i owns the conn_ids congruent to i
+// modulo the shard count, and the group steers datagrams by that residue.
+struct ServerShard final {
+  BsdUdpSocket socket;
+  EpollReactor reactor;
+};
 
-void run_server_app(const Rudp::Config::RuntimeProfile& profile,
-                    const LogSink& logger) {
-  install_signal_handlers();
-  g_stop_requested.store(false);
+[[nodiscard]] std::optional<BsdUdpSocket> open_server_socket(
+    const Rudp::Config::RuntimeProfile& profile,
+    std::uint16_t port,
+    bool reuse_port,
+    const LogSink& logger) {
   auto socket = BsdUdpSocket::create_non_blocking();
   if (!socket.has_value()) {
-    return;
+    return std::nullopt;
   }
-  if (!socket->bind(profile.bind_address, profile.bind_port)) {
-    return;
+  if (reuse_port && !socket->enable_reuse_port()) {
+    log_line(logger, "[server] SO_REUSEPORT unavailable; cannot shard");
+    return std::nullopt;
+  }
+  if (!socket->bind(profile.bind_address, port)) {
+    return std::nullopt;
+  }
+  if (profile.enable_gso && !socket->enable_gso()) {
+    log_line(logger, "[server] UDP GSO unavailable; sending one datagram per message");
+  }
+  if (profile.enable_gro && !socket->enable_gro()) {
+    log_line(logger, "[server] UDP GRO unavailable; receiving one datagram per slot");
+  }
+  if (profile.max_pacing_rate_bytes != 0 &&
+      !socket->set_max_pacing_rate(profile.max_pacing_rate_bytes)) {
+    log_line(logger, "[server] SO_MAX_PACING_RATE unavailable; relying on session pacing");
   }
+  return socket;
+}
+
+// Opens `count` sockets on the profile's port. With a single shard this is
+// the plain socket; otherwise all join one SO_REUSEPORT group, and an
+// ephemeral port picked by the first bind is reused by the rest.
+[[nodiscard]] std::vector<ServerShard> open_server_shards(
+    const Rudp::Config::RuntimeProfile& profile,
+    std::size_t count,
+    const LogSink& logger) {
+  std::vector<ServerShard> shards;
+  shards.reserve(count);
+  std::uint16_t port = profile.bind_port;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto socket = open_server_socket(profile, port, count > 1U,
+                                     i == 0 ? logger : LogSink{});
+    auto reactor = EpollReactor::create();
+    if (!socket.has_value() || !reactor.has_value()) {
+      return {};
+    }
+    if (i == 0) {
+      port = socket->local_port().value_or(port);
+    }
+    shards.push_back(ServerShard{
+        .socket = std::move(*socket),
+        .reactor = std::move(*reactor),
+    });
+  }
+  if (count > 1U &&
+      !shards.front().socket.steer_by_conn_id(
+          static_cast<std::uint32_t>(count))) {
+    log_line(logger, "[server] conn_id steering unavailable; relying on the 4-tuple hash");
+  }
+  return shards;
+}
 
-  ServerSessionManager manager;
+void serve_shard(const Rudp::Config::RuntimeProfile& profile,
+                 const LogSink& logger,
+                 ServerShard& shard,
+                 std::size_t shard_index,
+                 std::size_t shard_count,
+                 bool stdin_enabled) {
+  auto& socket = shard.socket;
+  auto& reactor = shard.reactor;
+  ServerSessionManager manager(Rudp::Session::ConnIdAllocator(
+      static_cast<std::uint32_t>(shard_index),
+      static_cast<std::uint32_t>(shard_count)));
+  auto receive_slots = make_receive_slots(
+      std::clamp<std::size_t>(profile.io_batch_size, 1U, kMaxDatagramBatch),
+      socket.gro_enabled()
+          ? std::max<std::size_t>(profile.socket_buffer_size, kMaxGroBufferSize)
+          : profile.socket_buffer_size);
+  TxBacklog tx_backlog;
   std::optional<std::uint32_t> preferred_conn_id;
   std::unordered_map<std::uint32_t, EndpointKey> active_endpoints;
-  bool stdin_enabled = ::isatty(STDIN_FILENO) != 0;
-  log_line(logger, std::string("server listening on ") + profile.bind_address +
-                       ':' + std::to_string(profile.bind_port));
-  if (stdin_enabled) {
-    log_line(logger,
-             "type a line to send on the default channel, or use: send <conn_id> <channel> <message>, /channels");
-  } else {
-    log_line(logger,
-             "[server] stdin is not interactive; runtime commands disabled");
+
+  const int socket_fd = socket.native_handle();
+  bool watching_writable = false;
+  if (!reactor.watch(socket_fd, true, watching_writable)) {
+    return;
+  }
+  if (stdin_enabled && !reactor.watch(STDIN_FILENO, true, false)) {
+    stdin_enabled = false;
   }
 
+  std::array<ReadyFd, 4> ready{};
+  std::optional<std::uint64_t> wake_at_ms = now_ms();
   bool should_exit = false;
   while (!should_exit) {
     if (g_stop_requested.load()) {
@@ -289,53 +363,130 @@ void run_server_app(const Rudp::Config::RuntimeProfile& profile,
       break;
     }
 
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(socket->native_handle(), &readfds);
-    int max_fd = socket->native_handle();
-    if (stdin_enabled) {
-      FD_SET(STDIN_FILENO, &readfds);
-      max_fd = std::max(max_fd, STDIN_FILENO);
+    const bool want_writable = !tx_backlog.empty();
+    if (want_writable != watching_writable) {
+      if (!reactor.watch(socket_fd, true, want_writable)) {
+        break;
+      }
+      watching_writable = want_writable;
     }
 
-    timeval timeout{};
-    timeout.tv_sec = 0;
-    timeout.tv_usec = static_cast<suseconds_t>(
-        profile.select_timeout_us);
-    const int ready = ::select(max_fd + 1, &readfds, nullptr, nullptr, &timeout);
-    if (ready < 0 && errno != EINTR) {
-      std::perror("select");
+    const auto ready_count = reactor.wait(wake_at_ms, ready);
+    if (!ready_count.has_value()) {
       break;
     }
-
-    if (FD_ISSET(socket->native_handle(), &readfds)) {
-      while (const auto received = socket->recv_from(
-                 profile.socket_buffer_size)) {
-        manager.on_datagram_received(received->endpoint, received->bytes, now_ms());
+    const std::span<const ReadyFd> ready_fds(ready.data(), *ready_count);
+
+    if (const auto* entry = find_ready(ready_fds, socket_fd);
+        entry != nullptr && entry->readable) {
+      for (;;) {
+        const auto received = socket.recv_batch(receive_slots);
+        const auto received_at_ms = now_ms();
+        for (std::size_t i = 0; i < received; ++i) {
+          for_each_datagram(receive_slots[i], [&](auto bytes) {
+            manager.on_datagram_received(receive_slots[i].endpoint, bytes,
+                                         received_at_ms);
+          });
+        }
         drain_server_events(manager, logger, preferred_conn_id, active_endpoints);
+        if (received < receive_slots.size()) {
+          break;
+        }
       }
     }
 
-    if (stdin_enabled && FD_ISSET(STDIN_FILENO, &readfds)) {
-      if (!std::cin.good()) {
-        stdin_enabled = false;
-      } else {
+    if (stdin_enabled && find_ready(ready_fds, STDIN_FILENO) != nullptr) {
+      if (std::cin.good()) {
         handle_server_stdin(profile, manager, logger, preferred_conn_id,
                             active_endpoints, should_exit);
-        if (!std::cin.good()) {
-          stdin_enabled = false;
-        }
+      }
+      if (!std::cin.good()) {
+        stdin_enabled = false;
+        static_cast<void>(reactor.unwatch(STDIN_FILENO));
       }
     }
 
-    for (auto& outbound : manager.poll_tx(now_ms())) {
-      static_cast<void>(socket->send_to(outbound.endpoint, outbound.bytes));
+    const auto polled_at_ms = now_ms();
+    flush_backlog(socket, tx_backlog);
+    bool tx_stalled = !tx_backlog.empty();
+    if (!tx_stalled) {
+      tx_stalled = manager.poll_tx_batch(polled_at_ms, profile.poll_budget,
+                                         tx_backlog.batch) == 0;
+      flush_backlog(socket, tx_backlog);
     }
     drain_server_events(manager, logger, preferred_conn_id, active_endpoints);
-    ::usleep(profile.loop_sleep_us);
+    wake_at_ms = reactor_deadline_ms(manager.next_deadline_ms(polled_at_ms),
+                                     polled_at_ms, tx_stalled);
   }
 
   log_server_summaries(manager, logger, active_endpoints);
 }
 
+}  // namespace
+
+void run_server_app(const Rudp::Config::RuntimeProfile& profile,
+                    const LogSink& logger) {
+  install_signal_handlers();
+  g_stop_requested.store(false);
+  const std::size_t shard_count =
+      profile.server_shards != 0
+          ? profile.server_shards
+          : std::max(std::thread::hardware_concurrency(), 1U);
+  auto shards = open_server_shards(profile, shard_count, logger);
+  if (shards.empty()) {
+    return;
+  }
+
+  const auto port = shards.front().socket.local_port().value_or(
+      profile.bind_port);
+  log_line(logger, std::string("server listening on ") + profile.bind_address +
+                       ':' + std::to_string(port) +
+                       (shard_count > 1U
+                            ? " with " + std::to_string(shard_count) + " shards"
+                            : std::string()));
+  if (shard_count == 1U) {
+    const bool stdin_enabled = ::isatty(STDIN_FILENO) != 0;
+    if (stdin_enabled) {
+      log_line(logger,
+               "type a line to send on the default channel, or use: send <conn_id> <channel> <message>, /channels");
+    } else {
+      log_line(logger,
+               "[server] stdin is not interactive; runtime commands disabled");
+    }
+    serve_shard(profile, logger, shards.front(), 0U, 1U, stdin_enabled);
+    return;
+  }
+
+  // Sessions live on the shard whose socket the kernel picked for their flow,
+  // so console commands, which address one session, are not offered.
+  log_line(logger, "[server] runtime commands disabled while sharded");
+  std::atomic<std::size_t> running{shard_count};
+  std::vector<std::thread> workers;
+  workers.reserve(shard_count);
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    const std::string tag = "[shard=" + std::to_string(i) + "] ";
+    LogSink shard_logger = [&logger, tag](std::string_view message) {
+      log_line(logger, tag + std::string(message));
+    };
+    workers.emplace_back([&profile, &shards, &running, i, shard_count,
+                          shard_logger = std::move(shard_logger)]() {
+      serve_shard(profile, shard_logger, shards[i], i, shard_count, false);
+      --running;
+    });
+  }
+
+  // A signal may land on any thread. The main thread notices the flag (or a
+  // shard that stopped on an error) and wakes every reactor to exit too.
+  while (!g_stop_requested.load() && running.load() == shard_count) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  g_stop_requested.store(true);
+  for (const auto& shard : shards) {
+    shard.reactor.notify();
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
 }  // namespace Rudp::Runtime
@@ -2,11 +2,16 @@
 
 #include <arpa/inet.h>
 #include <fcntl.h>
+#include <linux/filter.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
 #include <cerrno>
 #include <cstring>
 #include <iostream>
@@ -37,17 +42,132 @@ namespace {
   return addr;
 }
 
+// The socket is IPv4-only, so IPv6 endpoints have no wire form here.
+[[nodiscard]] std::optional<sockaddr_in> endpoint_sockaddr(
+    const Session::EndpointKey& endpoint) noexcept {
+  if (endpoint.family != Session::AddressFamily::IPv4) {
+    return std::nullopt;
+  }
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(endpoint.port);
+  std::memcpy(&addr.sin_addr, endpoint.address.data(), sizeof(addr.sin_addr));
+  return addr;
+}
+
+[[nodiscard]] Session::EndpointKey endpoint_from_sockaddr(
+    const sockaddr_in& addr) noexcept {
+  return Session::EndpointKey::ipv4(ntohl(addr.sin_addr.s_addr),
+                                    ntohs(addr.sin_port));
+}
+
+[[nodiscard]] bool is_transient_send_error(int error) noexcept {
+  return error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS;
+}
+
+#if defined(__linux__)
+// Kernel limits for a single UDP GSO send: at most this many segments, and
+// the whole super-datagram must fit in one IPv4 UDP payload.
+constexpr std::size_t kMaxGsoSegments = 64;
+constexpr std::size_t kMaxGsoBytes = 65507;
+
+struct GsoControl final {
+  alignas(cmsghdr) char buffer[CMSG_SPACE(sizeof(std::uint16_t))];
+};
+
+struct GroControl final {
+  alignas(cmsghdr) char buffer[CMSG_SPACE(sizeof(int))];
+};
+
+// Length of the run of `batch` starting at `first` (and ending before `end`)
+// that the kernel can send as one GSO super-datagram: same endpoint, equal
+// sizes, and an optional shorter final segment.
+[[nodiscard]] std::size_t gso_run_length(const Session::OutboundBatch& batch,
+                                         std::size_t first,
+                                         std::size_t end) {
+  const auto segment_size = batch.datagrams[first].size();
+  if (segment_size == 0) {
+    return 1;
+  }
+
+  std::size_t total = segment_size;
+  std::size_t run = 1;
+  while (first + run < end && run < kMaxGsoSegments) {
+    const auto next = first + run;
+    const auto next_size = batch.datagrams[next].size();
+    if (!(batch.endpoints[next] == batch.endpoints[first]) || next_size == 0 ||
+        next_size > segment_size || total + next_size > kMaxGsoBytes) {
+      break;
+    }
+    total += next_size;
+    ++run;
+    if (next_size < segment_size) {
+      break;
+    }
+  }
+  return run;
+}
+
+void attach_gso_segment_size(msghdr& header, GsoControl& control,
+                             std::size_t segment_size) {
+  header.msg_control = control.buffer;
+  header.msg_controllen = sizeof(control.buffer);
+  auto* cmsg = CMSG_FIRSTHDR(&header);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+  const auto value = static_cast<std::uint16_t>(segment_size);
+  std::memcpy(CMSG_DATA(cmsg), &value, sizeof(value));
+}
+
+// Returns the coalesced segment size reported by UDP GRO, or 0 when the
+// kernel delivered a single datagram.
+[[nodiscard]] std::size_t gro_segment_size(msghdr& header) {
+  for (auto* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&header, cmsg)) {
+    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+      int value = 0;
+      std::memcpy(&value, CMSG_DATA(cmsg), sizeof(value));
+      return value > 0 ? static_cast<std::size_t>(value) : 0U;
+    }
+  }
+  return 0;
+}
+#endif
+
 }  // namespace
 
+std::optional<Session::EndpointKey> resolve_endpoint(std::string_view address,
+                                                    std::uint16_t port) {
+  const auto addr = make_sockaddr(address, port);
+  if (!addr.has_value()) {
+    return std::nullopt;
+  }
+  return endpoint_from_sockaddr(*addr);
+}
+
+std::vector<ReceiveSlot> make_receive_slots(std::size_t slot_count,
+                                            std::size_t buffer_size) {
+  std::vector<ReceiveSlot> slots(slot_count);
+  for (auto& slot : slots) {
+    slot.buffer.resize(buffer_size);
+  }
+  return slots;
+}
+
 BsdUdpSocket::~BsdUdpSocket() { close(); }
 
 BsdUdpSocket::BsdUdpSocket(BsdUdpSocket&& other) noexcept
-    : fd_(std::exchange(other.fd_, -1)) {}
+    : fd_(std::exchange(other.fd_, -1)),
+      gso_enabled_(std::exchange(other.gso_enabled_, false)),
+      gro_enabled_(std::exchange(other.gro_enabled_, false)) {}
 
 BsdUdpSocket& BsdUdpSocket::operator=(BsdUdpSocket&& other) noexcept {
   if (this != &other) {
     close();
     fd_ = std::exchange(other.fd_, -1);
+    gso_enabled_ = std::exchange(other.gso_enabled_, false);
+    gro_enabled_ = std::exchange(other.gro_enabled_, false);
   }
   return *this;
 }
@@ -70,6 +190,51 @@ std::optional<BsdUdpSocket> BsdUdpSocket::create_non_blocking() {
   return BsdUdpSocket(fd);
 }
 
+bool BsdUdpSocket::enable_reuse_port() {
+#if defined(SO_REUSEPORT)
+  const int opt = 1;
+  return ::setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == 0;
+#else
+  return false;
+#endif
+}
+
+bool BsdUdpSocket::steer_by_conn_id(std::uint32_t shard_count) {
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+  if (shard_count == 0) {
+    return false;
+  }
+  // The program sees the UDP payload from offset 0, where the header starts
+  // with the big-endian ConnId. A result past the end of the group makes the
+  // kernel fall back to its hash, which is what ConnId 0 asks for.
+  std::array<sock_filter, 5> program{{
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 0),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 0, 1),
+      BPF_STMT(BPF_RET | BPF_K, 0xffffffffU),
+      BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, shard_count),
+      BPF_STMT(BPF_RET | BPF_A, 0),
+  }};
+  const sock_fprog fprog{
+      .len = static_cast<unsigned short>(program.size()),
+      .filter = program.data(),
+  };
+  return ::setsockopt(fd_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &fprog,
+                      sizeof(fprog)) == 0;
+#else
+  static_cast<void>(shard_count);
+  return false;
+#endif
+}
+
+std::optional<std::uint16_t> BsdUdpSocket::local_port() const {
+  sockaddr_in addr{};
+  socklen_t addr_len = sizeof(addr);
+  if (::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0) {
+    return std::nullopt;
+  }
+  return ntohs(addr.sin_port);
+}
+
 bool BsdUdpSocket::bind(std::string_view address, std::uint16_t port) {
   const auto addr = make_sockaddr(address, port);
   if (!addr.has_value()) {
@@ -90,9 +255,9 @@ bool BsdUdpSocket::bind(std::string_view address, std::uint16_t port) {
 
 bool BsdUdpSocket::send_to(const Session::EndpointKey& endpoint,
                            std::span<const std::byte> bytes) const {
-  const auto addr = make_sockaddr(endpoint.address, endpoint.port);
+  const auto addr = endpoint_sockaddr(endpoint);
   if (!addr.has_value()) {
-    std::cerr << "Invalid endpoint address: " << endpoint.address << '\n';
+    std::cerr << "Invalid endpoint address: " << endpoint.to_string() << '\n';
     return false;
   }
 
@@ -106,38 +271,206 @@ bool BsdUdpSocket::send_to(const Session::EndpointKey& endpoint,
   return true;
 }
 
-std::optional<ReceivedDatagram> BsdUdpSocket::recv_from(
-    std::size_t buffer_size) const {
-  std::vector<std::byte> buffer(buffer_size);
-  sockaddr_in addr{};
-  socklen_t addr_len = sizeof(addr);
-  const auto received =
-      ::recvfrom(fd_, buffer.data(), buffer.size(), 0,
-                 reinterpret_cast<sockaddr*>(&addr), &addr_len);
-  if (received < 0) {
-    if (errno == EAGAIN || errno == EWOULDBLOCK) {
-      return std::nullopt;
+std::size_t BsdUdpSocket::send_batch(const Session::OutboundBatch& batch,
+                                     std::size_t first) {
+  std::size_t consumed = first;
+  while (consumed < batch.size()) {
+    const auto chunk_limit =
+        std::min(batch.size() - consumed, kMaxDatagramBatch);
+    std::array<sockaddr_in, kMaxDatagramBatch> addrs{};
+    std::size_t prepared = 0;
+    for (; prepared < chunk_limit; ++prepared) {
+      const auto addr = endpoint_sockaddr(batch.endpoints[consumed + prepared]);
+      if (!addr.has_value()) {
+        break;
+      }
+      addrs[prepared] = *addr;
     }
-    std::perror("recvfrom");
-    return std::nullopt;
+
+    if (prepared == 0) {
+      // Endpoint without an IPv4 wire form: drop the datagram rather than stall the queue.
+      std::cerr << "Invalid endpoint address: "
+                << batch.endpoints[consumed].to_string() << '\n';
+      ++consumed;
+      continue;
+    }
+
+#if defined(__linux__)
+    std::array<iovec, kMaxDatagramBatch> iovecs{};
+    std::array<mmsghdr, kMaxDatagramBatch> messages{};
+    std::array<GsoControl, kMaxDatagramBatch> controls{};
+    std::array<std::size_t, kMaxDatagramBatch> segments_per_message{};
+    std::size_t message_count = 0;
+    for (std::size_t offset = 0; offset < prepared;) {
+      const auto run =
+          gso_enabled_
+              ? gso_run_length(batch, consumed + offset, consumed + prepared)
+              : 1U;
+      for (std::size_t i = offset; i < offset + run; ++i) {
+        const auto bytes = batch.datagrams[consumed + i];
+        iovecs[i].iov_base = const_cast<std::byte*>(bytes.data());
+        iovecs[i].iov_len = bytes.size();
+      }
+
+      auto& header = messages[message_count].msg_hdr;
+      header.msg_name = &addrs[offset];
+      header.msg_namelen = sizeof(addrs[offset]);
+      header.msg_iov = &iovecs[offset];
+      header.msg_iovlen = run;
+      if (run > 1U) {
+        attach_gso_segment_size(header, controls[message_count],
+                                iovecs[offset].iov_len);
+      }
+      segments_per_message[message_count] = run;
+      ++message_count;
+      offset += run;
+    }
+
+    const int sent = ::sendmmsg(fd_, messages.data(),
+                                static_cast<unsigned int>(message_count), 0);
+    if (sent < 0) {
+      if (is_transient_send_error(errno)) {
+        return consumed - first;
+      }
+      if (errno == EIO && segments_per_message[0] > 1U) {
+        // The egress device cannot segment for us; fall back to one datagram
+        // per message and retry the same chunk.
+        std::cerr << "UDP GSO rejected by device, disabling\n";
+        gso_enabled_ = false;
+        continue;
+      }
+      // The kernel refused this message outright (e.g. EMSGSIZE). Treat it
+      // as lost on the wire; reliable traffic recovers via retransmission.
+      std::perror("sendmmsg");
+      consumed += segments_per_message[0];
+      continue;
+    }
+    for (std::size_t i = 0; i < static_cast<std::size_t>(sent); ++i) {
+      consumed += segments_per_message[i];
+    }
+#else
+    for (std::size_t i = 0; i < prepared; ++i) {
+      const auto bytes = batch.datagrams[consumed];
+      const auto sent = ::sendto(fd_, bytes.data(), bytes.size(), 0,
+                                 reinterpret_cast<const sockaddr*>(&addrs[i]),
+                                 sizeof(addrs[i]));
+      if (sent < 0) {
+        if (is_transient_send_error(errno)) {
+          return consumed - first;
+        }
+        std::perror("sendto");
+      }
+      ++consumed;
+    }
+#endif
   }
+  return consumed - first;
+}
 
-  char address_buf[INET_ADDRSTRLEN] = {};
-  if (::inet_ntop(AF_INET, &addr.sin_addr, address_buf, sizeof(address_buf)) ==
-      nullptr) {
-    std::perror("inet_ntop");
-    return std::nullopt;
+std::size_t BsdUdpSocket::recv_batch(std::span<ReceiveSlot> slots) const {
+  const auto batch_size = std::min(slots.size(), kMaxDatagramBatch);
+  if (batch_size == 0) {
+    return 0;
   }
 
-  buffer.resize(static_cast<std::size_t>(received));
-  return ReceivedDatagram{
-      .endpoint =
-          Session::EndpointKey{
-              .address = address_buf,
-              .port = ntohs(addr.sin_port),
-          },
-      .bytes = std::move(buffer),
-  };
+  std::array<sockaddr_in, kMaxDatagramBatch> addrs{};
+  std::size_t received = 0;
+
+#if defined(__linux__)
+  std::array<iovec, kMaxDatagramBatch> iovecs{};
+  std::array<mmsghdr, kMaxDatagramBatch> messages{};
+  std::array<GroControl, kMaxDatagramBatch> controls{};
+  for (std::size_t i = 0; i < batch_size; ++i) {
+    iovecs[i].iov_base = slots[i].buffer.data();
+    iovecs[i].iov_len = slots[i].buffer.size();
+    messages[i].msg_hdr.msg_name = &addrs[i];
+    messages[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+    if (gro_enabled_) {
+      messages[i].msg_hdr.msg_control = controls[i].buffer;
+      messages[i].msg_hdr.msg_controllen = sizeof(controls[i].buffer);
+    }
+  }
+
+  const int count = ::recvmmsg(fd_, messages.data(),
+                               static_cast<unsigned int>(batch_size), 0,
+                               nullptr);
+  if (count < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      std::perror("recvmmsg");
+    }
+    return 0;
+  }
+  for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
+    slots[i].size = messages[i].msg_len;
+    slots[i].segment_size =
+        gro_enabled_ ? gro_segment_size(messages[i].msg_hdr) : 0U;
+  }
+  received = static_cast<std::size_t>(count);
+#else
+  for (; received < batch_size; ++received) {
+    auto& slot = slots[received];
+    socklen_t addr_len = sizeof(addrs[received]);
+    const auto result = ::recvfrom(
+        fd_, slot.buffer.data(), slot.buffer.size(), 0,
+        reinterpret_cast<sockaddr*>(&addrs[received]), &addr_len);
+    if (result < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        std::perror("recvfrom");
+      }
+      break;
+    }
+    slot.size = static_cast<std::size_t>(result);
+    slot.segment_size = 0;
+  }
+#endif
+
+  for (std::size_t i = 0; i < received; ++i) {
+    slots[i].endpoint = endpoint_from_sockaddr(addrs[i]);
+  }
+  return received;
+}
+
+bool BsdUdpSocket::enable_gso() {
+#if defined(__linux__)
+  int segment_size = 0;
+  socklen_t option_len = sizeof(segment_size);
+  // Probing the option is enough: kernels without UDP GSO reject it.
+  gso_enabled_ = ::getsockopt(fd_, SOL_UDP, UDP_SEGMENT, &segment_size,
+                              &option_len) == 0;
+#endif
+  return gso_enabled_;
+}
+
+bool BsdUdpSocket::enable_gro() {
+#if defined(__linux__)
+  const int opt = 1;
+  gro_enabled_ = ::setsockopt(fd_, SOL_UDP, UDP_GRO, &opt, sizeof(opt)) == 0;
+#endif
+  return gro_enabled_;
+}
+
+bool BsdUdpSocket::set_max_pacing_rate(std::uint64_t bytes_per_second) {
+#if defined(SO_MAX_PACING_RATE)
+  // The kernel accepts a 32-bit rate as well, but only a 64-bit one can
+  // express rates above ~4 GB/s.
+  return ::setsockopt(fd_, SOL_SOCKET, SO_MAX_PACING_RATE, &bytes_per_second,
+                      sizeof(bytes_per_second)) == 0;
+#else
+  static_cast<void>(bytes_per_second);
+  return false;
+#endif
+}
+
+void flush_backlog(BsdUdpSocket& socket, TxBacklog& backlog) {
+  if (!backlog.empty()) {
+    backlog.sent += socket.send_batch(backlog.batch, backlog.sent);
+  }
+  if (backlog.empty()) {
+    backlog.batch.clear();
+    backlog.sent = 0;
+  }
 }
 
 void BsdUdpSocket::close() noexcept {
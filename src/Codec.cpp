@@ -5,9 +5,92 @@
 #include "Rudp/Utils.hpp"
 
 namespace Rudp::Codec {
+namespace {
+
+constexpr std::size_t kTlvHeaderSize = 2;
+constexpr std::size_t kWindowTlvSize = 4;
+constexpr std::size_t kFeaturesTlvSize = 4;
+constexpr std::size_t kStreamSeqTlvSize = 4;
+constexpr std::size_t kSackRangeSize = 8;
+constexpr std::size_t kMaxExtensionsSize = kMaxHeaderLength - kHeaderLength;
+
+// Every known TLV at its largest must fit in the one-byte HeaderLen.
+static_assert(kTlvHeaderSize + kWindowTlvSize + kTlvHeaderSize +
+                  kFeaturesTlvSize + kTlvHeaderSize + kStreamSeqTlvSize +
+                  kTlvHeaderSize + kHandshakeCookieSize + kTlvHeaderSize +
+                  kMaxSackRanges * kSackRangeSize <=
+              kMaxExtensionsSize);
+
+// Checks TLV framing only: every entry must fit inside the extension area.
+[[nodiscard]] bool extensions_well_formed(
+    std::span<const std::byte> extensions) noexcept {
+  std::size_t offset = 0;
+  while (offset < extensions.size()) {
+    if (extensions.size() - offset < kTlvHeaderSize) {
+      return false;
+    }
+    const auto length = std::to_integer<std::size_t>(extensions[offset + 1]);
+    offset += kTlvHeaderSize;
+    if (extensions.size() - offset < length) {
+      return false;
+    }
+    offset += length;
+  }
+  return true;
+}
+
+[[nodiscard]] std::size_t write_tlv_header(std::span<std::byte> bytes,
+                                           std::size_t offset,
+                                           ExtensionType type,
+                                           std::size_t length) noexcept {
+  bytes[offset] = static_cast<std::byte>(type);
+  bytes[offset + 1] = static_cast<std::byte>(length);
+  return offset + kTlvHeaderSize;
+}
+
+void write_extensions(std::span<std::byte> bytes,
+                      std::size_t offset,
+                      const HeaderExtensions& extensions) noexcept {
+  if (extensions.window.has_value()) {
+    offset = write_tlv_header(bytes, offset, ExtensionType::Window,
+                              kWindowTlvSize);
+    Utils::writeU32(bytes, offset, *extensions.window);
+    offset += kWindowTlvSize;
+  }
+  if (extensions.features.has_value()) {
+    offset = write_tlv_header(bytes, offset, ExtensionType::Features,
+                              kFeaturesTlvSize);
+    Utils::writeU32(bytes, offset, *extensions.features);
+    offset += kFeaturesTlvSize;
+  }
+  if (extensions.stream_seq.has_value()) {
+    offset = write_tlv_header(bytes, offset, ExtensionType::StreamSeq,
+                              kStreamSeqTlvSize);
+    Utils::writeU32(bytes, offset, *extensions.stream_seq);
+    offset += kStreamSeqTlvSize;
+  }
+  if (extensions.cookie.has_value()) {
+    offset = write_tlv_header(bytes, offset, ExtensionType::Cookie,
+                              kHandshakeCookieSize);
+    std::copy(extensions.cookie->begin(), extensions.cookie->end(),
+              bytes.begin() + static_cast<std::ptrdiff_t>(offset));
+    offset += kHandshakeCookieSize;
+  }
+  if (extensions.sack_range_count != 0) {
+    offset = write_tlv_header(bytes, offset, ExtensionType::SackRanges,
+                              extensions.sack_range_count * kSackRangeSize);
+    for (const auto& range : extensions.sacks()) {
+      Utils::writeU32(bytes, offset, range.begin);
+      Utils::writeU32(bytes, offset + 4, range.end);
+      offset += kSackRangeSize;
+    }
+  }
+}
+
+}  // namespace
 
 bool isValidHeader(const Header& header) noexcept {
-  if (header.header_len != kHeaderLength) {
+  if (header.header_len < kHeaderLength) {
     return false;
   }
   if (header.reserved != 0) {
@@ -16,7 +99,8 @@ bool isValidHeader(const Header& header) noexcept {
   if (static_cast<std::uint8_t>(header.channel_type) > 3) {
     return false;
   }
-  return (header.flags & 0xc0U) == 0;
+  // A packet is either a bundle or a fragment, never both.
+  return !header.hasFlag(Flag::Bundle) || !header.hasFlag(Flag::Fragment);
 }
 
 std::optional<PacketView> decode(std::span<const std::byte> bytes) noexcept {
@@ -35,29 +119,244 @@ std::optional<PacketView> decode(std::span<const std::byte> bytes) noexcept {
   header_out.header_len = std::to_integer<std::uint8_t>(bytes[26]);
   header_out.reserved = std::to_integer<std::uint8_t>(bytes[27]);
 
-  if (!isValidHeader(header_out)) {
+  if (!isValidHeader(header_out) || bytes.size() < header_out.header_len) {
+    return std::nullopt;
+  }
+
+  const auto extensions =
+      bytes.subspan(kHeaderLength, header_out.header_len - kHeaderLength);
+  if (!extensions_well_formed(extensions)) {
+    return std::nullopt;
+  }
+  const auto payload = bytes.subspan(header_out.header_len);
+  if (header_out.hasFlag(Flag::Bundle) && !bundle_well_formed(payload)) {
+    return std::nullopt;
+  }
+  if (header_out.hasFlag(Flag::Fragment) &&
+      (!isReliableChannel(header_out.channel_type) ||
+       !read_fragment_header(payload).has_value())) {
     return std::nullopt;
   }
 
   return PacketView{
       .header = header_out,
-      .payload = bytes.subspan(kHeaderLength),
+      .payload = payload,
+      .extensions = extensions,
   };
 }
 
+std::optional<HeaderExtensions> decode_extensions(
+    std::span<const std::byte> extensions) noexcept {
+  HeaderExtensions decoded;
+  if (!extensions_well_formed(extensions)) {
+    return std::nullopt;
+  }
+
+  std::size_t offset = 0;
+  while (offset < extensions.size()) {
+    const auto type = std::to_integer<std::uint8_t>(extensions[offset]);
+    const auto length = std::to_integer<std::size_t>(extensions[offset + 1]);
+    const auto value = extensions.subspan(offset + kTlvHeaderSize, length);
+    offset += kTlvHeaderSize + length;
+
+    switch (static_cast<ExtensionType>(type)) {
+      case ExtensionType::Window:
+        if (length != kWindowTlvSize) {
+          return std::nullopt;
+        }
+        decoded.window = Utils::readU32(value, 0);
+        break;
+      case ExtensionType::Features:
+        if (length != kFeaturesTlvSize) {
+          return std::nullopt;
+        }
+        decoded.features = Utils::readU32(value, 0);
+        break;
+      case ExtensionType::StreamSeq:
+        if (length != kStreamSeqTlvSize) {
+          return std::nullopt;
+        }
+        decoded.stream_seq = Utils::readU32(value, 0);
+        break;
+      case ExtensionType::Cookie:
+        if (length != kHandshakeCookieSize) {
+          return std::nullopt;
+        }
+        decoded.cookie.emplace();
+        std::copy(value.begin(), value.end(), decoded.cookie->begin());
+        break;
+      case ExtensionType::SackRanges:
+        if (length == 0 || length % kSackRangeSize != 0 ||
+            length / kSackRangeSize > kMaxSackRanges) {
+          return std::nullopt;
+        }
+        decoded.sack_range_count =
+            static_cast<std::uint8_t>(length / kSackRangeSize);
+        for (std::size_t i = 0; i < decoded.sack_range_count; ++i) {
+          decoded.sack_ranges[i] = SackRange{
+              .begin = Utils::readU32(value, i * kSackRangeSize),
+              .end = Utils::readU32(value, i * kSackRangeSize + 4),
+          };
+        }
+        break;
+      default:
+        // Unknown TLVs are skipped so newer peers can add extensions.
+        break;
+    }
+  }
+  return decoded;
+}
+
+std::size_t encoded_extensions_size(const HeaderExtensions& extensions) noexcept {
+  std::size_t size = 0;
+  if (extensions.window.has_value()) {
+    size += kTlvHeaderSize + kWindowTlvSize;
+  }
+  if (extensions.features.has_value()) {
+    size += kTlvHeaderSize + kFeaturesTlvSize;
+  }
+  if (extensions.stream_seq.has_value()) {
+    size += kTlvHeaderSize + kStreamSeqTlvSize;
+  }
+  if (extensions.cookie.has_value()) {
+    size += kTlvHeaderSize + kHandshakeCookieSize;
+  }
+  if (extensions.sack_range_count != 0) {
+    size += kTlvHeaderSize + extensions.sack_range_count * kSackRangeSize;
+  }
+  return size;
+}
+
+std::optional<std::span<const std::byte>> next_bundled_message(
+    std::span<const std::byte> payload,
+    std::size_t& offset) noexcept {
+  if (payload.size() - offset < kBundleRecordHeaderSize) {
+    return std::nullopt;
+  }
+  const std::size_t length = Utils::readU16(payload, offset);
+  if (payload.size() - offset - kBundleRecordHeaderSize < length) {
+    return std::nullopt;
+  }
+  const auto message = payload.subspan(offset + kBundleRecordHeaderSize, length);
+  offset += kBundleRecordHeaderSize + length;
+  return message;
+}
+
+bool bundle_well_formed(std::span<const std::byte> payload) noexcept {
+  std::size_t offset = 0;
+  while (offset < payload.size()) {
+    if (!next_bundled_message(payload, offset).has_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void append_bundled_message(std::vector<std::byte>& bundle,
+                            std::span<const std::byte> message) {
+  const auto offset = bundle.size();
+  bundle.resize(offset + kBundleRecordHeaderSize + message.size());
+  Utils::writeU16(bundle, offset, static_cast<std::uint16_t>(message.size()));
+  std::ranges::copy(message,
+                    bundle.begin() + static_cast<std::ptrdiff_t>(
+                                         offset + kBundleRecordHeaderSize));
+}
+
+std::optional<FragmentHeader> read_fragment_header(
+    std::span<const std::byte> payload) noexcept {
+  if (payload.size() < kFragmentHeaderSize) {
+    return std::nullopt;
+  }
+  const FragmentHeader fragment{
+      .message_size = Utils::readU32(payload, 0),
+      .index = Utils::readU16(payload, 4),
+      .count = Utils::readU16(payload, 6),
+      .first_seq = Utils::readU32(payload, 8),
+  };
+  if (fragment.index >= fragment.count) {
+    return std::nullopt;
+  }
+  return fragment;
+}
+
+void write_fragment_header(std::span<std::byte> out,
+                           const FragmentHeader& fragment) noexcept {
+  Utils::writeU32(out, 0, fragment.message_size);
+  Utils::writeU16(out, 4, fragment.index);
+  Utils::writeU16(out, 6, fragment.count);
+  Utils::writeU32(out, 8, fragment.first_seq);
+}
+
+std::size_t fragment_slice_size(std::size_t max_datagram_bytes) noexcept {
+  // Data packets never carry WINDOW or FEATURES; their largest header has a
+  // STREAM_SEQ and a full SACK_RANGES TLV. A client only echoes a COOKIE
+  // before it has received anything past the SYN-ACK, so never alongside
+  // SACK ranges, and the cookie is the smaller of the two.
+  constexpr std::size_t kMaxDataHeaderSize =
+      kHeaderLength + kTlvHeaderSize + kStreamSeqTlvSize + kTlvHeaderSize +
+      kMaxSackRanges * kSackRangeSize;
+  constexpr std::size_t kOverhead = kMaxDataHeaderSize + kFragmentHeaderSize;
+  return max_datagram_bytes > kOverhead ? max_datagram_bytes - kOverhead : 0U;
+}
+
+std::vector<std::byte> encode(const Header& header,
+                              std::span<const std::byte> payload) {
+  return encode(header, HeaderExtensions{}, payload);
+}
+
+std::size_t encoded_size(const HeaderExtensions& extensions,
+                         std::size_t payload_size) noexcept {
+  return kHeaderLength + encoded_extensions_size(extensions) + payload_size;
+}
+
+std::optional<std::size_t> encode_into(
+    std::span<std::byte> out,
+    const Header& header,
+    const HeaderExtensions& extensions,
+    std::span<const std::byte> payload) noexcept {
+  const auto header_len = kHeaderLength + encoded_extensions_size(extensions);
+  const auto total = header_len + payload.size();
+  if (out.size() < total) {
+    return std::nullopt;
+  }
+
+  Utils::writeU32(out, 0, header.conn_id);
+  Utils::writeU32(out, 4, header.seq);
+  Utils::writeU32(out, 8, header.ack);
+  Utils::writeU64(out, 12, header.ack_bits);
+  Utils::writeU32(out, 20, header.channel_id);
+  out[24] = static_cast<std::byte>(header.channel_type);
+  out[25] = static_cast<std::byte>(header.flags);
+  out[26] = static_cast<std::byte>(header_len);
+  out[27] = static_cast<std::byte>(header.reserved);
+  write_extensions(out, kHeaderLength, extensions);
+  std::copy(payload.begin(), payload.end(), out.begin() + header_len);
+  return total;
+}
+
+bool patch_ack(std::span<std::byte> datagram,
+               std::uint32_t ack,
+               std::uint64_t ack_bits,
+               const HeaderExtensions& extensions) noexcept {
+  if (datagram.size() < kHeaderLength) {
+    return false;
+  }
+  const auto header_len = std::to_integer<std::size_t>(datagram[26]);
+  if (header_len != kHeaderLength + encoded_extensions_size(extensions) ||
+      datagram.size() < header_len) {
+    return false;
+  }
+  Utils::writeU32(datagram, 8, ack);
+  Utils::writeU64(datagram, 12, ack_bits);
+  write_extensions(datagram, kHeaderLength, extensions);
+  return true;
+}
+
 std::vector<std::byte> encode(const Header& header,
+                              const HeaderExtensions& extensions,
                               std::span<const std::byte> payload) {
-  std::vector<std::byte> bytes(kHeaderLength + payload.size());
-  Utils::writeU32(bytes, 0, header.conn_id);
-  Utils::writeU32(bytes, 4, header.seq);
-  Utils::writeU32(bytes, 8, header.ack);
-  Utils::writeU64(bytes, 12, header.ack_bits);
-  Utils::writeU32(bytes, 20, header.channel_id);
-  bytes[24] = static_cast<std::byte>(header.channel_type);
-  bytes[25] = static_cast<std::byte>(header.flags);
-  bytes[26] = static_cast<std::byte>(header.header_len);
-  bytes[27] = static_cast<std::byte>(header.reserved);
-  std::copy(payload.begin(), payload.end(), bytes.begin() + kHeaderLength);
+  std::vector<std::byte> bytes(encoded_size(extensions, payload.size()));
+  static_cast<void>(encode_into(bytes, header, extensions, payload));
   return bytes;
 }
 
@@ -31,6 +31,52 @@ bool assign_integer(Integer& target,
   }
 }
 
+bool assign_bool(bool& target,
+                 std::string_view raw_value,
+                 std::string* error_message,
+                 std::string_view key) {
+  if (!Rudp::Utils::parseBool(raw_value, target)) {
+    if (error_message != nullptr) {
+      *error_message = "invalid boolean for key " + std::string(key);
+    }
+    return false;
+  }
+  return true;
+}
+
+[[nodiscard]] std::optional<CongestionControl> parse_congestion_control(
+    std::string_view value) {
+  if (value == "none") {
+    return CongestionControl::None;
+  }
+  if (value == "newreno") {
+    return CongestionControl::NewReno;
+  }
+  if (value == "cubic") {
+    return CongestionControl::Cubic;
+  }
+  if (value == "bbr_lite") {
+    return CongestionControl::BbrLite;
+  }
+  return std::nullopt;
+}
+
+bool assign_congestion_control(CongestionControl& target,
+                               std::string_view raw_value,
+                               std::string* error_message,
+                               std::string_view key) {
+  const auto parsed = parse_congestion_control(raw_value);
+  if (!parsed.has_value()) {
+    if (error_message != nullptr) {
+      *error_message = std::string(key) +
+                       " must be none, newreno, cubic, or bbr_lite";
+    }
+    return false;
+  }
+  target = *parsed;
+  return true;
+}
+
 bool apply_kv(Settings& settings,
               std::string_view key,
               std::string_view value,
@@ -44,6 +90,9 @@ bool apply_kv(Settings& settings,
   if (key == "RUDP_TRANSPORT_MAX_RTO_MS") {
     return assign_integer(transport.max_rto_ms, value, error_message, key);
   }
+  if (key == "RUDP_TRANSPORT_MIN_RTO_MS") {
+    return assign_integer(transport.min_rto_ms, value, error_message, key);
+  }
   if (key == "RUDP_TRANSPORT_MAX_RETRANSMIT_COUNT") {
     return assign_integer(transport.max_retransmit_count, value, error_message,
                           key);
@@ -67,6 +116,67 @@ bool apply_kv(Settings& settings,
     return assign_integer(transport.fast_retx_evidence_threshold, value,
                           error_message, key);
   }
+  if (key == "RUDP_TRANSPORT_RELIABLE_WINDOW_PACKETS") {
+    std::uint32_t window = 0;
+    if (!assign_integer(window, value, error_message, key)) {
+      return false;
+    }
+    if (window < Rudp::kReliableWindowSize ||
+        window > Rudp::kMaxReliableWindowSize) {
+      if (error_message != nullptr) {
+        *error_message = "out of range value for key " + std::string(key);
+      }
+      return false;
+    }
+    transport.reliable_window_packets = window;
+    return true;
+  }
+  if (key == "RUDP_TRANSPORT_CONGESTION_CONTROL") {
+    return assign_congestion_control(transport.congestion_control,
+                                     Rudp::Utils::unquote(value),
+                                     error_message, key);
+  }
+  if (key == "RUDP_TRANSPORT_ENABLE_PACING") {
+    return assign_bool(transport.enable_pacing, value, error_message, key);
+  }
+  if (key == "RUDP_TRANSPORT_PACING_RATE_PPS") {
+    return assign_integer(transport.pacing_rate_pps, value, error_message, key);
+  }
+  if (key == "RUDP_TRANSPORT_PACING_BURST_PACKETS") {
+    return assign_integer(transport.pacing_burst_packets, value, error_message,
+                          key);
+  }
+  if (key == "RUDP_TRANSPORT_ENABLE_BUNDLING") {
+    return assign_bool(transport.enable_bundling, value, error_message, key);
+  }
+  if (key == "RUDP_TRANSPORT_ENABLE_FRAGMENTATION") {
+    return assign_bool(transport.enable_fragmentation, value, error_message,
+                       key);
+  }
+  if (key == "RUDP_TRANSPORT_ENABLE_ORDERED_STREAMS") {
+    return assign_bool(transport.enable_ordered_streams, value, error_message,
+                       key);
+  }
+  if (key == "RUDP_TRANSPORT_ENABLE_HANDSHAKE_COOKIES") {
+    return assign_bool(transport.enable_handshake_cookies, value, error_message,
+                       key);
+  }
+  if (key == "RUDP_TRANSPORT_MAX_DATAGRAM_BYTES") {
+    return assign_integer(transport.max_datagram_bytes, value, error_message,
+                          key);
+  }
+  if (key == "RUDP_TRANSPORT_MAX_REASSEMBLY_BYTES") {
+    return assign_integer(transport.max_reassembly_bytes, value, error_message,
+                          key);
+  }
+  if (key == "RUDP_TRANSPORT_RETIRED_CONN_ID_QUIET_MS") {
+    return assign_integer(transport.retired_conn_id_quiet_ms, value,
+                          error_message, key);
+  }
+  if (key == "RUDP_TRANSPORT_MAX_RETIRED_CONN_IDS") {
+    return assign_integer(transport.max_retired_conn_ids, value, error_message,
+                          key);
+  }
   if (key == "RUDP_TRANSPORT_ENABLE_ACTIVITY_ACK_ONLY") {
     bool parsed = false;
     if (!Rudp::Utils::parseBool(value, parsed)) {
@@ -99,16 +209,24 @@ bool apply_kv(Settings& settings,
   if (key == "RUDP_RUNTIME_SOCKET_BUFFER_SIZE") {
     return assign_integer(runtime.socket_buffer_size, value, error_message, key);
   }
-  if (key == "RUDP_RUNTIME_SERVER_LOOP_SLEEP_US") {
-    return assign_integer(runtime.server_loop_sleep_us, value, error_message,
-                          key);
+  if (key == "RUDP_RUNTIME_CLIENT_POLL_BUDGET") {
+    return assign_integer(runtime.client_poll_budget, value, error_message, key);
   }
-  if (key == "RUDP_RUNTIME_CLIENT_SELECT_TIMEOUT_US") {
-    return assign_integer(runtime.client_select_timeout_us, value, error_message,
+  if (key == "RUDP_RUNTIME_IO_BATCH_SIZE") {
+    return assign_integer(runtime.io_batch_size, value, error_message, key);
+  }
+  if (key == "RUDP_RUNTIME_ENABLE_GSO") {
+    return assign_bool(runtime.enable_gso, value, error_message, key);
+  }
+  if (key == "RUDP_RUNTIME_ENABLE_GRO") {
+    return assign_bool(runtime.enable_gro, value, error_message, key);
+  }
+  if (key == "RUDP_RUNTIME_MAX_PACING_RATE_BYTES") {
+    return assign_integer(runtime.max_pacing_rate_bytes, value, error_message,
                           key);
   }
-  if (key == "RUDP_RUNTIME_CLIENT_POLL_BUDGET") {
-    return assign_integer(runtime.client_poll_budget, value, error_message, key);
+  if (key == "RUDP_RUNTIME_SERVER_SHARDS") {
+    return assign_integer(runtime.server_shards, value, error_message, key);
   }
   if (key == "RUDP_RUNTIME_SERVER_LOG_PATH") {
     runtime.server_log_path = Rudp::Utils::unquote(value);
@@ -167,9 +285,19 @@ bool assign_yaml_integer(Integer& target,
       .remote_port = runtime.client_server_port,
       .log_path = runtime.server_log_path,
       .socket_buffer_size = runtime.socket_buffer_size,
-      .loop_sleep_us = runtime.server_loop_sleep_us,
-      .select_timeout_us = runtime.client_select_timeout_us,
       .poll_budget = runtime.client_poll_budget,
+      .io_batch_size = runtime.io_batch_size,
+      .enable_gso = runtime.enable_gso,
+      .enable_gro = runtime.enable_gro,
+      .max_pacing_rate_bytes = runtime.max_pacing_rate_bytes,
+      .server_shards = runtime.server_shards,
+      .congestion_control = g_settings.transport.congestion_control,
+      .enable_pacing = g_settings.transport.enable_pacing,
+      .enable_bundling = g_settings.transport.enable_bundling,
+      .enable_fragmentation = g_settings.transport.enable_fragmentation,
+      .enable_ordered_streams = g_settings.transport.enable_ordered_streams,
+      .enable_handshake_cookies =
+          g_settings.transport.enable_handshake_cookies,
       .channels = {},
   };
 }
@@ -226,18 +354,60 @@ bool apply_profile_field(RuntimeProfile& profile,
       return assign_yaml_integer(profile.socket_buffer_size, value,
                                  error_message, "runtime.socket_buffer_size");
     }
-    if (key == "loop_sleep_us") {
-      return assign_yaml_integer(profile.loop_sleep_us, value, error_message,
-                                 "runtime.loop_sleep_us");
-    }
-    if (key == "select_timeout_us") {
-      return assign_yaml_integer(profile.select_timeout_us, value,
-                                 error_message, "runtime.select_timeout_us");
-    }
     if (key == "poll_budget") {
       return assign_yaml_integer(profile.poll_budget, value, error_message,
                                  "runtime.poll_budget");
     }
+    if (key == "io_batch_size") {
+      return assign_yaml_integer(profile.io_batch_size, value, error_message,
+                                 "runtime.io_batch_size");
+    }
+    if (key == "enable_gso") {
+      return assign_bool(profile.enable_gso, value, error_message,
+                         "runtime.enable_gso");
+    }
+    if (key == "enable_gro") {
+      return assign_bool(profile.enable_gro, value, error_message,
+                         "runtime.enable_gro");
+    }
+    if (key == "max_pacing_rate_bytes") {
+      return assign_yaml_integer(profile.max_pacing_rate_bytes, value,
+                                 error_message,
+                                 "runtime.max_pacing_rate_bytes");
+    }
+    if (key == "server_shards") {
+      return assign_yaml_integer(profile.server_shards, value, error_message,
+                                 "runtime.server_shards");
+    }
+    return true;
+  }
+
+  if (scope == "transport") {
+    if (key == "congestion_control") {
+      return assign_congestion_control(profile.congestion_control, value,
+                                       error_message,
+                                       "transport.congestion_control");
+    }
+    if (key == "enable_pacing") {
+      return assign_bool(profile.enable_pacing, value, error_message,
+                         "transport.enable_pacing");
+    }
+    if (key == "enable_bundling") {
+      return assign_bool(profile.enable_bundling, value, error_message,
+                         "transport.enable_bundling");
+    }
+    if (key == "enable_fragmentation") {
+      return assign_bool(profile.enable_fragmentation, value, error_message,
+                         "transport.enable_fragmentation");
+    }
+    if (key == "enable_ordered_streams") {
+      return assign_bool(profile.enable_ordered_streams, value, error_message,
+                         "transport.enable_ordered_streams");
+    }
+    if (key == "enable_handshake_cookies") {
+      return assign_bool(profile.enable_handshake_cookies, value,
+                         error_message, "transport.enable_handshake_cookies");
+    }
     return true;
   }
 
@@ -298,6 +468,23 @@ bool apply_channel_field(ChannelDefinition& channel,
     }
     return true;
   }
+  if (key == "priority") {
+    return assign_yaml_integer(channel.priority, value, error_message,
+                               "channels[].priority");
+  }
+  if (key == "weight") {
+    if (!assign_yaml_integer(channel.weight, value, error_message,
+                             "channels[].weight")) {
+      return false;
+    }
+    if (channel.weight == 0U) {
+      if (error_message != nullptr) {
+        *error_message = "channels[].weight must be at least 1";
+      }
+      return false;
+    }
+    return true;
+  }
   return true;
 }
 
@@ -373,7 +560,8 @@ bool apply_profile_yaml(RuntimeProfile& profile,
     }
 
     if (indent == 2U &&
-        (section == "runtime" || section == "connection")) {
+        (section == "runtime" || section == "transport" ||
+         section == "connection")) {
       if (!parse_key_value(trimmed, key, value) ||
           !apply_profile_field(profile, section, key, value, error_message)) {
         if (error_message != nullptr && error_message->empty()) {
@@ -398,6 +586,8 @@ bool apply_profile_yaml(RuntimeProfile& profile,
         .name = "default",
         .type = Rudp::ChannelType::Unreliable,
         .is_default = true,
+        .priority = 0,
+        .weight = 1,
     });
   } else if (std::ranges::none_of(
                  profile.channels, [](const ChannelDefinition& channel) {
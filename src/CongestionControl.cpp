@@ -0,0 +1,258 @@
+#include "Rudp/CongestionControl.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Rudp::Session {
+namespace {
+
+// RFC 8312 constants.
+constexpr double kCubicC = 0.4;
+constexpr double kCubicBeta = 0.7;
+
+constexpr double kBbrMinWindow = 4.0;
+constexpr double kBbrCwndGain = 2.0;
+constexpr double kBbrFullBwGrowth = 1.25;
+constexpr std::uint32_t kBbrFullBwRounds = 3;
+constexpr std::uint64_t kBbrBwWindowRounds = 10;
+constexpr std::uint64_t kBbrMinRttWindowMs = 10'000;
+
+// The window never needs to exceed the largest negotiable reliable window.
+constexpr double kMaxWindow = static_cast<double>(Rudp::kMaxReliableWindowSize);
+
+}  // namespace
+
+CongestionController::CongestionController(Algorithm algorithm) noexcept
+    : algorithm_(algorithm) {}
+
+std::uint32_t CongestionController::window_packets() const noexcept {
+  if (algorithm_ == Algorithm::None) {
+    return std::numeric_limits<std::uint32_t>::max();
+  }
+  return static_cast<std::uint32_t>(std::max(1.0, std::floor(cwnd_)));
+}
+
+bool CongestionController::can_send(std::size_t inflight_packets) const noexcept {
+  return algorithm_ == Algorithm::None || inflight_packets < window_packets();
+}
+
+std::optional<double> CongestionController::bottleneck_rate() const noexcept {
+  if (algorithm_ != Algorithm::BbrLite || max_bw_ <= 0.0) {
+    return std::nullopt;
+  }
+  return max_bw_ * 1000.0;
+}
+
+DeliveryStamp CongestionController::delivery_stamp(
+    std::uint64_t now_ms) const noexcept {
+  return DeliveryStamp{
+      .delivered = delivered_,
+      .delivered_ms = delivered_ == 0 ? now_ms : delivered_ms_,
+  };
+}
+
+void CongestionController::on_packet_acked(const DeliveryStamp& sent,
+                                           std::uint64_t now_ms) noexcept {
+  ++delivered_;
+  delivered_ms_ = now_ms;
+  ++acked_since_ack_;
+
+  // Millisecond clocks make sub-millisecond intervals read as zero; treat
+  // them as one so loopback still yields a (conservative) rate.
+  const auto interval_ms =
+      std::max<std::uint64_t>(1U, now_ms >= sent.delivered_ms
+                                      ? now_ms - sent.delivered_ms
+                                      : 0U);
+  const auto rate = static_cast<double>(delivered_ - sent.delivered) /
+                    static_cast<double>(interval_ms);
+  ack_rate_sample_ = std::max(ack_rate_sample_, rate);
+
+  if (sent.delivered >= next_round_delivered_) {
+    round_started_ = true;
+  }
+}
+
+void CongestionController::on_ack_processed(
+    std::uint32_t cumulative_ack,
+    std::optional<std::uint64_t> rtt_sample_ms,
+    std::uint64_t srtt_us,
+    std::uint64_t now_ms) noexcept {
+  if (recovering_ && !Rudp::seq_lt(cumulative_ack, recovery_end_)) {
+    recovering_ = false;
+    fast_recovery_ = false;
+  }
+  if (round_started_) {
+    ++round_count_;
+    next_round_delivered_ = delivered_;
+  }
+
+  const auto acked = acked_since_ack_;
+  switch (algorithm_) {
+    case Algorithm::None:
+      break;
+    case Algorithm::NewReno:
+      if (acked != 0 && !fast_recovery_) {
+        grow_new_reno(acked);
+      }
+      break;
+    case Algorithm::Cubic:
+      if (acked != 0 && !fast_recovery_) {
+        grow_cubic(acked, srtt_us, now_ms);
+      }
+      break;
+    case Algorithm::BbrLite:
+      update_bbr_filters(rtt_sample_ms, now_ms);
+      if (acked != 0) {
+        grow_bbr(acked);
+      }
+      break;
+  }
+
+  acked_since_ack_ = 0;
+  ack_rate_sample_ = 0.0;
+  round_started_ = false;
+}
+
+void CongestionController::on_fast_loss(std::uint32_t seq,
+                                        std::uint32_t next_seq,
+                                        std::uint64_t now_ms) noexcept {
+  static_cast<void>(now_ms);
+  // BbrLite steers by its bandwidth/RTT model rather than by isolated losses.
+  if (algorithm_ == Algorithm::None || algorithm_ == Algorithm::BbrLite ||
+      in_recovery(seq)) {
+    return;
+  }
+  reduce_on_loss();
+  cwnd_ = ssthresh_;
+  enter_recovery(next_seq);
+  fast_recovery_ = true;
+}
+
+void CongestionController::on_retransmit_timeout(std::uint32_t seq,
+                                                 std::uint32_t next_seq,
+                                                 std::uint64_t now_ms) noexcept {
+  static_cast<void>(now_ms);
+  if (algorithm_ == Algorithm::None) {
+    return;
+  }
+  const double loss_window =
+      algorithm_ == Algorithm::BbrLite ? kBbrMinWindow : 1.0;
+  if (in_recovery(seq) && cwnd_ <= loss_window) {
+    return;
+  }
+  if (algorithm_ != Algorithm::BbrLite) {
+    reduce_on_loss();
+  }
+  cwnd_ = loss_window;
+  enter_recovery(next_seq);
+  // After a timeout the window restarts in slow start instead of holding.
+  fast_recovery_ = false;
+}
+
+void CongestionController::grow_new_reno(std::uint32_t acked) noexcept {
+  if (in_slow_start()) {
+    cwnd_ += acked;
+  } else {
+    cwnd_ += static_cast<double>(acked) / cwnd_;
+  }
+  cwnd_ = std::min(cwnd_, kMaxWindow);
+}
+
+void CongestionController::grow_cubic(std::uint32_t acked,
+                                      std::uint64_t srtt_us,
+                                      std::uint64_t now_ms) noexcept {
+  if (in_slow_start()) {
+    cwnd_ = std::min(cwnd_ + acked, kMaxWindow);
+    return;
+  }
+
+  if (!epoch_start_ms_.has_value()) {
+    epoch_start_ms_ = now_ms;
+    if (cwnd_ < w_max_) {
+      cubic_k_s_ = std::cbrt((w_max_ - cwnd_) / kCubicC);
+    } else {
+      cubic_k_s_ = 0.0;
+      w_max_ = cwnd_;
+    }
+    w_est_ = cwnd_;
+  }
+
+  // W_cubic(t + RTT), bounded to 1.5x per RTT as RFC 8312 section 4.1 advises.
+  const double t =
+      static_cast<double>(now_ms - *epoch_start_ms_) / 1000.0 +
+      static_cast<double>(srtt_us) / 1'000'000.0;
+  double target = w_max_ + kCubicC * std::pow(t - cubic_k_s_, 3.0);
+  target = std::min(target, 1.5 * cwnd_);
+
+  // TCP-friendly region (section 4.2).
+  w_est_ += 3.0 * (1.0 - kCubicBeta) / (1.0 + kCubicBeta) *
+            static_cast<double>(acked) / cwnd_;
+  target = std::max(target, w_est_);
+
+  if (target > cwnd_) {
+    cwnd_ += (target - cwnd_) / cwnd_ * static_cast<double>(acked);
+  }
+  cwnd_ = std::min(cwnd_, kMaxWindow);
+}
+
+void CongestionController::grow_bbr(std::uint32_t acked) noexcept {
+  if (!pipe_filled_ || !min_rtt_ms_.has_value() || max_bw_ <= 0.0) {
+    // Startup: grow like slow start until the bandwidth plateaus.
+    cwnd_ = std::min(cwnd_ + acked, kMaxWindow);
+    return;
+  }
+  const double bdp = max_bw_ * static_cast<double>(*min_rtt_ms_);
+  const double target = std::clamp(kBbrCwndGain * bdp, kBbrMinWindow, kMaxWindow);
+  cwnd_ = cwnd_ < target ? std::min(cwnd_ + acked, target) : target;
+}
+
+void CongestionController::update_bbr_filters(
+    std::optional<std::uint64_t> rtt_sample_ms,
+    std::uint64_t now_ms) noexcept {
+  if (rtt_sample_ms.has_value() &&
+      (!min_rtt_ms_.has_value() || *rtt_sample_ms <= *min_rtt_ms_ ||
+       now_ms - min_rtt_stamp_ms_ > kBbrMinRttWindowMs)) {
+    // A zero RTT (sub-millisecond path) would zero the BDP; floor it at 1 ms.
+    min_rtt_ms_ = std::max<std::uint64_t>(*rtt_sample_ms, 1U);
+    min_rtt_stamp_ms_ = now_ms;
+  }
+
+  if (ack_rate_sample_ > 0.0 &&
+      (ack_rate_sample_ >= max_bw_ ||
+       round_count_ - max_bw_round_ >= kBbrBwWindowRounds)) {
+    max_bw_ = ack_rate_sample_;
+    max_bw_round_ = round_count_;
+  }
+
+  if (round_started_ && !pipe_filled_ && max_bw_ > 0.0) {
+    if (max_bw_ >= full_bw_ * kBbrFullBwGrowth) {
+      full_bw_ = max_bw_;
+      full_bw_rounds_ = 0;
+    } else if (++full_bw_rounds_ >= kBbrFullBwRounds) {
+      pipe_filled_ = true;
+    }
+  }
+}
+
+bool CongestionController::in_recovery(std::uint32_t seq) const noexcept {
+  return recovering_ && Rudp::seq_lt(seq, recovery_end_);
+}
+
+void CongestionController::enter_recovery(std::uint32_t next_seq) noexcept {
+  recovering_ = true;
+  recovery_end_ = next_seq;
+}
+
+void CongestionController::reduce_on_loss() noexcept {
+  if (algorithm_ == Algorithm::Cubic) {
+    epoch_start_ms_.reset();
+    // Fast convergence (RFC 8312 section 4.6).
+    w_max_ = cwnd_ < w_max_ ? cwnd_ * (1.0 + kCubicBeta) / 2.0 : cwnd_;
+    ssthresh_ = std::max(cwnd_ * kCubicBeta, kMinWindow);
+    return;
+  }
+  ssthresh_ = std::max(cwnd_ / 2.0, kMinWindow);
+}
+
+}  // namespace Rudp::Session
@@ -0,0 +1,63 @@
+#include "Rudp/ConnIdAllocator.hpp"
+
+#include <bit>
+#include <limits>
+#include <random>
+
+namespace Rudp::Session {
+namespace {
+
+[[nodiscard]] std::uint64_t random_key() {
+  std::random_device rd;
+  return (static_cast<std::uint64_t>(rd()) << 32U) | rd();
+}
+
+}  // namespace
+
+ConnIdAllocator::ConnIdAllocator(std::uint32_t shard_index,
+                                 std::uint32_t shard_count)
+    : ConnIdAllocator(shard_index, shard_count, random_key()) {}
+
+ConnIdAllocator::ConnIdAllocator(std::uint32_t shard_index,
+                                 std::uint32_t shard_count,
+                                 std::uint64_t key) noexcept
+    : shard_count_(shard_count == 0 ? 1U : shard_count), key_(key) {
+  shard_index_ = shard_index % shard_count_;
+  constexpr auto kMaxId = std::uint64_t{std::numeric_limits<std::uint32_t>::max()};
+  slot_count_ = (kMaxId - shard_index_) / shard_count_ + 1U;
+  domain_bits_ = static_cast<unsigned>(std::bit_width(slot_count_ - 1U));
+  mask_ = (std::uint64_t{1} << domain_bits_) - 1U;
+  // Start each shard at an unpredictable point of its sequence.
+  counter_ = key_ % slot_count_;
+}
+
+std::uint32_t ConnIdAllocator::next() noexcept {
+  while (true) {
+    const auto slot = permute(counter_ % slot_count_);
+    ++counter_;
+    const auto id = slot * shard_count_ + shard_index_;
+    if (id != 0U) {
+      return static_cast<std::uint32_t>(id);
+    }
+  }
+}
+
+std::uint64_t ConnIdAllocator::permute(std::uint64_t slot) const noexcept {
+  // Each step is a bijection on [0, mask_]: multiplication by an odd
+  // constant, xor with a right shift of itself, and keyed addition. Walking
+  // the cycle until the value lands below slot_count_ keeps it a bijection
+  // on [0, slot_count_); slot_count_ exceeds half the domain, so this takes
+  // under two rounds on average.
+  const unsigned shift = domain_bits_ / 2U + 1U;
+  auto value = slot;
+  do {
+    for (unsigned round = 0; round < 3U; ++round) {
+      value = (value * 0x9e3779b97f4a7c15ULL) & mask_;
+      value ^= value >> shift;
+      value = (value + (key_ >> (round * 16U))) & mask_;
+    }
+  } while (value >= slot_count_);
+  return value;
+}
+
+}  // namespace Rudp::Session
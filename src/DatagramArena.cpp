@@ -0,0 +1,34 @@
+#include "Rudp/DatagramArena.hpp"
+
+#include <algorithm>
+
+namespace Rudp::Session {
+
+DatagramArena::DatagramArena(std::size_t reserve_bytes)
+    : storage_(reserve_bytes) {}
+
+std::span<std::byte> DatagramArena::prepare(std::size_t size) {
+  if (storage_.size() - used_ < size) {
+    storage_.resize(std::max(used_ + size, storage_.size() * 2U));
+  }
+  return std::span<std::byte>(storage_).subspan(used_, size);
+}
+
+void DatagramArena::commit(std::size_t size) {
+  extents_.push_back(Extent{.offset = used_, .size = size});
+  used_ += size;
+}
+
+void DatagramArena::clear() noexcept {
+  used_ = 0;
+  extents_.clear();
+}
+
+std::span<const std::byte> DatagramArena::operator[](
+    std::size_t index) const noexcept {
+  const auto& extent = extents_[index];
+  return std::span<const std::byte>(storage_).subspan(extent.offset,
+                                                      extent.size);
+}
+
+}  // namespace Rudp::Session
@@ -0,0 +1,183 @@
+#include "Rudp/EpollReactor.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <utility>
+
+namespace Rudp::Runtime {
+namespace {
+
+constexpr std::size_t kMaxReadyEvents = 16;
+
+void drain_counter(int fd) noexcept {
+  std::uint64_t value = 0;
+  while (::read(fd, &value, sizeof(value)) == sizeof(value)) {
+  }
+}
+
+[[nodiscard]] bool add_internal_fd(int epoll_fd, int fd) {
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  return ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+}  // namespace
+
+EpollReactor::~EpollReactor() { close(); }
+
+EpollReactor::EpollReactor(EpollReactor&& other) noexcept
+    : epoll_fd_(std::exchange(other.epoll_fd_, -1)),
+      timer_fd_(std::exchange(other.timer_fd_, -1)),
+      wake_fd_(std::exchange(other.wake_fd_, -1)),
+      armed_deadline_ms_(std::exchange(other.armed_deadline_ms_, std::nullopt)) {}
+
+EpollReactor& EpollReactor::operator=(EpollReactor&& other) noexcept {
+  if (this != &other) {
+    close();
+    epoll_fd_ = std::exchange(other.epoll_fd_, -1);
+    timer_fd_ = std::exchange(other.timer_fd_, -1);
+    wake_fd_ = std::exchange(other.wake_fd_, -1);
+    armed_deadline_ms_ = std::exchange(other.armed_deadline_ms_, std::nullopt);
+  }
+  return *this;
+}
+
+std::optional<EpollReactor> EpollReactor::create() {
+  const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0) {
+    std::perror("epoll_create1");
+    return std::nullopt;
+  }
+  // Construct early so every descriptor below is closed on failure.
+  EpollReactor reactor(epoll_fd, -1, -1);
+
+  reactor.timer_fd_ =
+      ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (reactor.timer_fd_ < 0) {
+    std::perror("timerfd_create");
+    return std::nullopt;
+  }
+  reactor.wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (reactor.wake_fd_ < 0) {
+    std::perror("eventfd");
+    return std::nullopt;
+  }
+  if (!add_internal_fd(epoll_fd, reactor.timer_fd_) ||
+      !add_internal_fd(epoll_fd, reactor.wake_fd_)) {
+    std::perror("epoll_ctl");
+    return std::nullopt;
+  }
+  return reactor;
+}
+
+bool EpollReactor::watch(int fd, bool readable, bool writable) {
+  epoll_event event{};
+  event.events = (readable ? EPOLLIN : 0U) | (writable ? EPOLLOUT : 0U);
+  event.data.fd = fd;
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == 0) {
+    return true;
+  }
+  if (errno == ENOENT &&
+      ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0) {
+    return true;
+  }
+  std::perror("epoll_ctl");
+  return false;
+}
+
+bool EpollReactor::unwatch(int fd) {
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) == 0) {
+    return true;
+  }
+  std::perror("epoll_ctl");
+  return false;
+}
+
+void EpollReactor::notify() const noexcept {
+  const std::uint64_t one = 1;
+  // A full counter already guarantees a pending wakeup, so EAGAIN is fine.
+  static_cast<void>(::write(wake_fd_, &one, sizeof(one)));
+}
+
+bool EpollReactor::arm_timer(std::optional<std::uint64_t> deadline_ms) {
+  if (deadline_ms == armed_deadline_ms_) {
+    return true;
+  }
+
+  itimerspec spec{};
+  if (deadline_ms.has_value()) {
+    // An all-zero it_value disarms the timer, so never arm for time 0.
+    const auto deadline = std::max<std::uint64_t>(*deadline_ms, 1U);
+    spec.it_value.tv_sec = static_cast<time_t>(deadline / 1000U);
+    spec.it_value.tv_nsec = static_cast<long>((deadline % 1000U) * 1'000'000U);
+  }
+  if (::timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+    std::perror("timerfd_settime");
+    return false;
+  }
+  armed_deadline_ms_ = deadline_ms;
+  return true;
+}
+
+std::optional<std::size_t> EpollReactor::wait(
+    std::optional<std::uint64_t> deadline_ms,
+    std::span<ReadyFd> ready) {
+  if (!arm_timer(deadline_ms)) {
+    return std::nullopt;
+  }
+
+  std::array<epoll_event, kMaxReadyEvents> events{};
+  const int count = ::epoll_wait(epoll_fd_, events.data(),
+                                 static_cast<int>(events.size()), -1);
+  if (count < 0) {
+    if (errno == EINTR) {
+      return 0;
+    }
+    std::perror("epoll_wait");
+    return std::nullopt;
+  }
+
+  std::size_t written = 0;
+  for (int i = 0; i < count; ++i) {
+    const int fd = events[i].data.fd;
+    if (fd == timer_fd_) {
+      drain_counter(timer_fd_);
+      // An expired absolute timer stays disarmed until set again.
+      armed_deadline_ms_.reset();
+      continue;
+    }
+    if (fd == wake_fd_) {
+      drain_counter(wake_fd_);
+      continue;
+    }
+    if (written == ready.size()) {
+      continue;
+    }
+    // Errors and hangups surface as readable so the owner sees them on read.
+    ready[written++] = ReadyFd{
+        .fd = fd,
+        .readable = (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0,
+        .writable = (events[i].events & EPOLLOUT) != 0,
+    };
+  }
+  return written;
+}
+
+void EpollReactor::close() noexcept {
+  for (int* fd : {&wake_fd_, &timer_fd_, &epoll_fd_}) {
+    if (*fd >= 0) {
+      ::close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+}  // namespace Rudp::Runtime
@@ -0,0 +1,161 @@
+#include "Rudp/HandshakeCookies.hpp"
+
+#include <array>
+#include <bit>
+#include <random>
+#include <span>
+
+#include "Rudp/ServerSessionManager.hpp"
+#include "Rudp/Utils.hpp"
+
+namespace Rudp::Session {
+namespace {
+
+// Cookie layout: IssuedMs, ClientIsn, Window, Features, Tag (low 32 bits),
+// each a big-endian uint32.
+constexpr std::size_t kIssuedOffset = 0;
+constexpr std::size_t kClientIsnOffset = 4;
+constexpr std::size_t kWindowOffset = 8;
+constexpr std::size_t kFeaturesOffset = 12;
+constexpr std::size_t kTagOffset = 16;
+static_assert(kTagOffset + 4U == kHandshakeCookieSize);
+
+// Endpoint (16 + 2 + 1 bytes), conn_id, issue time and the CookieSyn.
+constexpr std::size_t kTagInputSize = 19U + 4U * 5U;
+
+[[nodiscard]] std::uint64_t random_u64() {
+  std::random_device rd;
+  return (static_cast<std::uint64_t>(rd()) << 32U) | rd();
+}
+
+void sip_round(std::array<std::uint64_t, 4>& v) noexcept {
+  v[0] += v[1];
+  v[1] = std::rotl(v[1], 13);
+  v[1] ^= v[0];
+  v[0] = std::rotl(v[0], 32);
+  v[2] += v[3];
+  v[3] = std::rotl(v[3], 16);
+  v[3] ^= v[2];
+  v[0] += v[3];
+  v[3] = std::rotl(v[3], 21);
+  v[3] ^= v[0];
+  v[2] += v[1];
+  v[1] = std::rotl(v[1], 17);
+  v[1] ^= v[2];
+  v[2] = std::rotl(v[2], 32);
+}
+
+// SipHash-2-4 (Aumasson and Bernstein), reading the message little-endian
+// as the reference does.
+[[nodiscard]] std::uint64_t siphash24(std::uint64_t key0,
+                                      std::uint64_t key1,
+                                      std::span<const std::byte> message) noexcept {
+  std::array<std::uint64_t, 4> v{
+      key0 ^ 0x736f6d6570736575ULL,
+      key1 ^ 0x646f72616e646f6dULL,
+      key0 ^ 0x6c7967656e657261ULL,
+      key1 ^ 0x7465646279746573ULL,
+  };
+  const auto absorb = [&v](std::uint64_t word) {
+    v[3] ^= word;
+    sip_round(v);
+    sip_round(v);
+    v[0] ^= word;
+  };
+
+  const std::size_t full = message.size() / 8U * 8U;
+  for (std::size_t offset = 0; offset < full; offset += 8U) {
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < 8U; ++i) {
+      word |= std::to_integer<std::uint64_t>(message[offset + i]) << (8U * i);
+    }
+    absorb(word);
+  }
+  std::uint64_t last = static_cast<std::uint64_t>(message.size() & 0xffU)
+                       << 56U;
+  for (std::size_t i = 0; full + i < message.size(); ++i) {
+    last |= std::to_integer<std::uint64_t>(message[full + i]) << (8U * i);
+  }
+  absorb(last);
+
+  v[2] ^= 0xffU;
+  for (int i = 0; i < 4; ++i) {
+    sip_round(v);
+  }
+  return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+}  // namespace
+
+HandshakeCookies::HandshakeCookies()
+    : HandshakeCookies(random_u64(), random_u64()) {}
+
+HandshakeCookies::HandshakeCookies(std::uint64_t key0,
+                                   std::uint64_t key1) noexcept
+    : key0_(key0), key1_(key1) {}
+
+IssuedCookie HandshakeCookies::issue(const EndpointKey& endpoint,
+                                     std::uint32_t conn_id,
+                                     const CookieSyn& syn,
+                                     std::uint64_t now_ms) const noexcept {
+  const auto issued_ms = static_cast<std::uint32_t>(now_ms);
+  const auto mac = tag(endpoint, conn_id, issued_ms, syn);
+
+  IssuedCookie issued;
+  Utils::writeU32(issued.cookie, kIssuedOffset, issued_ms);
+  Utils::writeU32(issued.cookie, kClientIsnOffset, syn.client_isn);
+  Utils::writeU32(issued.cookie, kWindowOffset, syn.window);
+  Utils::writeU32(issued.cookie, kFeaturesOffset, syn.features);
+  Utils::writeU32(issued.cookie, kTagOffset, static_cast<std::uint32_t>(mac));
+  issued.server_isn = static_cast<std::uint32_t>(mac >> 32U);
+  return issued;
+}
+
+std::optional<CookieSyn> HandshakeCookies::verify(
+    const EndpointKey& endpoint,
+    std::uint32_t conn_id,
+    std::uint32_t server_isn,
+    const Rudp::HandshakeCookie& cookie,
+    std::uint64_t now_ms,
+    std::uint64_t lifetime_ms) const noexcept {
+  const auto issued_ms = Utils::readU32(cookie, kIssuedOffset);
+  // Issue times are truncated to 32 bits; compare them modulo 2^32.
+  const auto age_ms = static_cast<std::uint32_t>(now_ms) - issued_ms;
+  if (age_ms > lifetime_ms) {
+    return std::nullopt;
+  }
+
+  const CookieSyn syn{
+      .client_isn = Utils::readU32(cookie, kClientIsnOffset),
+      .window = Utils::readU32(cookie, kWindowOffset),
+      .features = Utils::readU32(cookie, kFeaturesOffset),
+  };
+  const auto mac = tag(endpoint, conn_id, issued_ms, syn);
+  if (static_cast<std::uint32_t>(mac) != Utils::readU32(cookie, kTagOffset) ||
+      static_cast<std::uint32_t>(mac >> 32U) != server_isn) {
+    return std::nullopt;
+  }
+  return syn;
+}
+
+std::uint64_t HandshakeCookies::tag(const EndpointKey& endpoint,
+                                    std::uint32_t conn_id,
+                                    std::uint32_t issued_ms,
+                                    const CookieSyn& syn) const noexcept {
+  std::array<std::byte, kTagInputSize> input{};
+  std::size_t offset = 0;
+  for (const auto octet : endpoint.address) {
+    input[offset++] = static_cast<std::byte>(octet);
+  }
+  Utils::writeU16(input, offset, endpoint.port);
+  offset += 2U;
+  input[offset++] = static_cast<std::byte>(endpoint.family);
+  for (const auto value :
+       {conn_id, issued_ms, syn.client_isn, syn.window, syn.features}) {
+    Utils::writeU32(input, offset, value);
+    offset += 4U;
+  }
+  return siphash24(key0_, key1_, input);
+}
+
+}  // namespace Rudp::Session
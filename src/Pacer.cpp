@@ -0,0 +1,59 @@
+#include "Rudp/Pacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Rudp::Session {
+
+Pacer::Pacer(std::uint32_t burst_packets) noexcept
+    : burst_(static_cast<double>(std::max<std::uint32_t>(burst_packets, 1U))),
+      tokens_(burst_) {}
+
+void Pacer::set_rate(std::optional<double> packets_per_second,
+                     std::uint64_t now_ms) noexcept {
+  tokens_ = tokens_at(now_ms);
+  last_update_ms_ = std::max(last_update_ms_, now_ms);
+  rate_per_ms_ = packets_per_second.has_value() && *packets_per_second > 0.0
+                     ? *packets_per_second / 1000.0
+                     : 0.0;
+}
+
+std::optional<double> Pacer::rate() const noexcept {
+  if (rate_per_ms_ <= 0.0) {
+    return std::nullopt;
+  }
+  return rate_per_ms_ * 1000.0;
+}
+
+bool Pacer::can_send(std::uint64_t now_ms) const noexcept {
+  return rate_per_ms_ <= 0.0 || tokens_at(now_ms) >= 1.0;
+}
+
+void Pacer::on_sent(std::uint64_t now_ms) noexcept {
+  if (rate_per_ms_ <= 0.0) {
+    return;
+  }
+  tokens_ = tokens_at(now_ms) - 1.0;
+  last_update_ms_ = std::max(last_update_ms_, now_ms);
+}
+
+std::uint64_t Pacer::next_send_ms(std::uint64_t now_ms) const noexcept {
+  const auto tokens = tokens_at(now_ms);
+  if (rate_per_ms_ <= 0.0 || tokens >= 1.0) {
+    return now_ms;
+  }
+  const auto wait_ms = std::ceil((1.0 - tokens) / rate_per_ms_);
+  return now_ms + std::max<std::uint64_t>(static_cast<std::uint64_t>(wait_ms), 1U);
+}
+
+double Pacer::tokens_at(std::uint64_t now_ms) const noexcept {
+  if (rate_per_ms_ <= 0.0) {
+    return burst_;
+  }
+  const auto elapsed_ms =
+      now_ms > last_update_ms_ ? static_cast<double>(now_ms - last_update_ms_)
+                               : 0.0;
+  return std::min(burst_, tokens_ + elapsed_ms * rate_per_ms_);
+}
+
+}  // namespace Rudp::Session
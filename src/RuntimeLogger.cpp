@@ -5,6 +5,7 @@
 
 #include <filesystem>
 #include <iostream>
+#include <mutex>
 #include <utility>
 
 namespace Rudp::Runtime {
@@ -35,7 +36,12 @@ void log_line(const LogSink& logger, std::string_view message) {
 }
 
 LogSink make_console_logger() {
-  return [](std::string_view message) { std::cout << message << '\n'; };
+  // Sharded servers log from several threads; keep their lines whole.
+  return [](std::string_view message) {
+    static std::mutex mutex;
+    std::scoped_lock lock(mutex);
+    std::cout << message << '\n';
+  };
 }
 
 LogSink make_text_logger(std::string logger_name, std::string log_path) {
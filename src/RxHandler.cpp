@@ -1,5 +1,10 @@
 #include "Rudp/RxHandler.hpp"
 
+#include "Rudp/Codec.hpp"
+
+#include <algorithm>
+#include <utility>
+
 namespace Rudp::Session
 {
   namespace
@@ -7,72 +12,238 @@ namespace Rudp::Session
 
     [[nodiscard]] OwnedPacket make_owned_packet(const Rudp::PacketView &packet)
     {
+      // A fragment's data already sits in its Reassembly; only the prefix is
+      // needed to deliver it in order.
+      const auto payload = packet.header.hasFlag(Rudp::Flag::Fragment)
+                               ? packet.payload.first(Rudp::kFragmentHeaderSize)
+                               : packet.payload;
       return OwnedPacket{
           .header = packet.header,
-          .payload =
-              std::vector<std::byte>(packet.payload.begin(), packet.payload.end()),
+          .payload = std::vector<std::byte>(payload.begin(), payload.end()),
       };
     }
 
-    [[nodiscard]] SessionEvent make_data_event(const Rudp::PacketView &packet)
+    [[nodiscard]] SessionEvent make_data_event(const Rudp::Header &header,
+                                               std::vector<std::byte> payload)
     {
       return SessionEvent{
           .type = SessionEvent::Type::DataReceived,
-          .seq = packet.header.seq,
-          .channel_id = packet.header.channel_id,
-          .channel_type = packet.header.channel_type,
-          .payload =
-              std::vector<std::byte>(packet.payload.begin(), packet.payload.end()),
+          .seq = header.seq,
+          .channel_id = header.channel_id,
+          .channel_type = header.channel_type,
+          .payload = std::move(payload),
           .error_message = {},
       };
     }
 
+    // A BUNDLE payload becomes one event per message, all with the datagram's
+    // seq; the codec already rejected malformed bundles.
+    void push_data_events(const Rudp::Header &header,
+                          std::span<const std::byte> payload,
+                          RxSessionState &rx)
+    {
+      if (!header.hasFlag(Rudp::Flag::Bundle))
+      {
+        rx.pending_events.push_back(make_data_event(
+            header, std::vector<std::byte>(payload.begin(), payload.end())));
+        return;
+      }
+
+      std::size_t offset = 0;
+      while (const auto message = Rudp::Codec::next_bundled_message(payload, offset))
+      {
+        rx.pending_events.push_back(make_data_event(
+            header, std::vector<std::byte>(message->begin(), message->end())));
+      }
+    }
+
+    // Checked before the fragment is acknowledged: a fragment that would start
+    // a message past max_reassembly_bytes is dropped so the sender retries.
+    [[nodiscard]] bool reassembly_has_room(const Rudp::PacketView &packet,
+                                           const RxSessionState &rx)
+    {
+      const auto fragment = Rudp::Codec::read_fragment_header(packet.payload);
+      if (rx.reassembly.contains(fragment->first_seq))
+      {
+        return true;
+      }
+      return fragment->message_size <= rx.max_reassembly_bytes &&
+             rx.reassembly_bytes <=
+                 rx.max_reassembly_bytes - fragment->message_size;
+    }
+
+    void drop_reassembly(std::uint32_t first_seq, RxSessionState &rx)
+    {
+      const auto it = rx.reassembly.find(first_seq);
+      if (it != rx.reassembly.end())
+      {
+        rx.reassembly_bytes -= it->second.payload.size();
+        rx.reassembly.erase(it);
+      }
+    }
+
+    // Copies a fragment's data into its message, creating the Reassembly on
+    // first sight. A fragment that disagrees with the rest of its message
+    // discards the whole message. Returns the message's FirstSeq.
+    std::uint32_t place_fragment(const Rudp::PacketView &packet,
+                                 RxSessionState &rx)
+    {
+      const auto fragment = *Rudp::Codec::read_fragment_header(packet.payload);
+      const auto data = packet.payload.subspan(Rudp::kFragmentHeaderSize);
+      const std::uint32_t first_seq = fragment.first_seq;
+
+      auto [it, inserted] = rx.reassembly.try_emplace(first_seq);
+      auto &entry = it->second;
+      if (inserted)
+      {
+        entry.channel_id = packet.header.channel_id;
+        entry.channel_type = packet.header.channel_type;
+        entry.fragment_count = fragment.count;
+        entry.payload.resize(fragment.message_size);
+        rx.reassembly_bytes += fragment.message_size;
+      }
+
+      // Every fragment but the last carries the same number of bytes.
+      const bool last = fragment.index + 1U == fragment.count;
+      const std::size_t message_size = fragment.message_size;
+      const bool consistent =
+          entry.channel_id == packet.header.channel_id &&
+          entry.channel_type == packet.header.channel_type &&
+          entry.fragment_count == fragment.count &&
+          entry.payload.size() == message_size &&
+          data.size() <= message_size && (last || !data.empty());
+      const std::size_t offset =
+          last ? message_size - data.size()
+               : static_cast<std::size_t>(fragment.index) * data.size();
+      if (!consistent || offset > message_size - data.size())
+      {
+        drop_reassembly(first_seq, rx);
+        return first_seq;
+      }
+
+      std::ranges::copy(data, entry.payload.begin() +
+                                  static_cast<std::ptrdiff_t>(offset));
+      ++entry.received_count;
+      return first_seq;
+    }
+
+    // Emits the message once every fragment has been placed.
+    void emit_reassembled(std::uint32_t first_seq, RxSessionState &rx)
+    {
+      const auto it = rx.reassembly.find(first_seq);
+      if (it == rx.reassembly.end() ||
+          it->second.received_count != it->second.fragment_count)
+      {
+        return;
+      }
+
+      auto &entry = it->second;
+      rx.reassembly_bytes -= entry.payload.size();
+      rx.pending_events.push_back(SessionEvent{
+          .type = SessionEvent::Type::DataReceived,
+          .seq = first_seq,
+          .channel_id = entry.channel_id,
+          .channel_type = entry.channel_type,
+          .payload = std::move(entry.payload),
+          .error_message = {},
+      });
+      rx.reassembly.erase(it);
+    }
+
+    // Ordered delivery of one seq. Fragments were placed on arrival, so a
+    // message is emitted when its last fragment comes up in order.
+    void deliver_ordered(const Rudp::Header &header,
+                         std::span<const std::byte> payload,
+                         RxSessionState &rx)
+    {
+      if (!header.hasFlag(Rudp::Flag::Fragment))
+      {
+        push_data_events(header, payload, rx);
+        return;
+      }
+
+      const auto fragment = Rudp::Codec::read_fragment_header(payload);
+      if (fragment->index + 1U == fragment->count)
+      {
+        emit_reassembled(fragment->first_seq, rx);
+      }
+    }
+
     [[nodiscard]] bool is_control_only(ControlKind control_kind)
     {
       return control_kind != ControlKind::None;
     }
 
+    // Runs after update_reliable_receive_state(), so `seq` is behind
+    // next_expected exactly when it just filled the ACK front.
     void ensure_ordered_delivery_started(std::uint32_t seq,
                                          RxSessionState &rx)
     {
       if (!rx.ordered_delivery_started)
       {
-        rx.next_ordered_delivery = seq;
+        rx.next_ordered_delivery =
+            Rudp::seq_lt(seq, rx.next_expected) ? seq : rx.next_expected;
         rx.ordered_delivery_started = true;
       }
     }
 
     void advance_receive_window(RxSessionState &rx)
     {
-      ++rx.next_expected;
-
-      while ((rx.received_bits & 1ULL) != 0ULL)
+      // Bit k of received_bits stands for next_expected + k + 1, so moving the
+      // front by one shifts the bitmap by one, whether or not bit 0 was set.
+      bool next_received = true;
+      while (next_received)
       {
         ++rx.next_expected;
+        next_received = (rx.received_bits & 1ULL) != 0ULL;
         rx.received_bits >>= 1U;
+
+        // Bit 63 now stands for next_expected + 64; pull it in from the
+        // beyond-bitmap set if that seq already arrived.
+        const std::uint32_t incoming =
+            rx.next_expected + static_cast<std::uint32_t>(Rudp::kAckBitsWindow);
+        if (rx.received_beyond.any() && rx.received_beyond.test(incoming))
+        {
+          rx.received_beyond.reset(incoming);
+          rx.received_bits |= 1ULL << (Rudp::kAckBitsWindow - 1U);
+        }
       }
     }
 
+    void deliver_owned_ordered(OwnedPacket packet, RxSessionState &rx)
+    {
+      if (packet.header.hasFlag(Rudp::Flag::Bundle) ||
+          packet.header.hasFlag(Rudp::Flag::Fragment))
+      {
+        deliver_ordered(packet.header, packet.payload, rx);
+        return;
+      }
+      rx.pending_events.push_back(
+          make_data_event(packet.header, std::move(packet.payload)));
+    }
+
+    // Session-wide order: every seq behind the ACK front has arrived, so
+    // buffered packets up to next_expected are released and seqs that belonged
+    // to other channels or to control packets are stepped over.
     void drain_contiguous_ordered(RxSessionState &rx)
     {
       if (!rx.ordered_delivery_started)
       {
         return;
       }
+      if (rx.ordered_reorder_buffer.empty())
+      {
+        rx.next_ordered_delivery = rx.next_expected;
+        return;
+      }
 
-      for (auto it = rx.ordered_reorder_buffer.find(rx.next_ordered_delivery);
-           it != rx.ordered_reorder_buffer.end();
-           it = rx.ordered_reorder_buffer.find(rx.next_ordered_delivery))
+      while (Rudp::seq_lt(rx.next_ordered_delivery, rx.next_expected))
       {
-        rx.pending_events.push_back(SessionEvent{
-            .type = SessionEvent::Type::DataReceived,
-            .seq = it->second.header.seq,
-            .channel_id = it->second.header.channel_id,
-            .channel_type = it->second.header.channel_type,
-            .payload = it->second.payload,
-            .error_message = {},
-        });
-        rx.ordered_reorder_buffer.erase(it);
+        if (rx.ordered_reorder_buffer.contains(rx.next_ordered_delivery))
+        {
+          deliver_owned_ordered(
+              rx.ordered_reorder_buffer.take(rx.next_ordered_delivery), rx);
+        }
         ++rx.next_ordered_delivery;
       }
     }
@@ -83,22 +254,47 @@ namespace Rudp::Session
                                       std::uint64_t now_ms,
                                       ControlKind control_kind,
                                       RxSessionState &rx)
+  {
+    return on_packet(packet, Rudp::HeaderExtensions{}, now_ms, control_kind,
+                     rx);
+  }
+
+  RxPacketResult RxHandler::on_packet(const Rudp::PacketView &packet,
+                                      const Rudp::HeaderExtensions &extensions,
+                                      std::uint64_t now_ms,
+                                      ControlKind control_kind,
+                                      RxSessionState &rx)
   {
     static_cast<void>(now_ms);
     RxPacketResult result;
 
+    if (packet.header.hasFlag(Rudp::Flag::Fragment) &&
+        !reassembly_has_room(packet, rx))
+    {
+      return result;
+    }
+
     const bool should_process_payload =
         update_reliable_receive_state(packet, control_kind, result, rx);
 
     if (is_control_only(control_kind) || !should_process_payload)
     {
+      // Any reliable seq may be what session-wide ordered delivery waits on.
+      drain_contiguous_ordered(rx);
       return result;
     }
 
     switch (packet.header.channel_type)
     {
     case Rudp::ChannelType::ReliableOrdered:
-      handle_reliable_ordered(packet, rx);
+      if (extensions.stream_seq.has_value())
+      {
+        handle_ordered_stream(packet, *extensions.stream_seq, rx);
+      }
+      else
+      {
+        handle_reliable_ordered(packet, rx);
+      }
       break;
     case Rudp::ChannelType::ReliableUnordered:
       handle_reliable_unordered(packet, rx);
@@ -111,6 +307,7 @@ namespace Rudp::Session
       break;
     }
 
+    drain_contiguous_ordered(rx);
     return result;
   }
 
@@ -161,7 +358,14 @@ namespace Rudp::Session
         return !already_received;
       }
 
-      // Reliable packets outside the tracked ACK bitmap window cannot be
+      if (delta <= rx.receive_window)
+      {
+        const bool already_received = rx.received_beyond.test(packet.header.seq);
+        rx.received_beyond.set(packet.header.seq);
+        return !already_received;
+      }
+
+      // Reliable packets past the advertised receive window cannot be
       // represented in current RX state, so they are not delivered yet.
       return false;
     }
@@ -177,8 +381,54 @@ namespace Rudp::Session
     // PacketView is parse-time only and must not escape this function. Store an
     // owned copy if it needs to survive for reorder handling.
     ensure_ordered_delivery_started(packet.header.seq, rx);
-    rx.ordered_reorder_buffer[packet.header.seq] = make_owned_packet(packet);
-    drain_contiguous_ordered(rx);
+    if (packet.header.hasFlag(Rudp::Flag::Fragment))
+    {
+      place_fragment(packet, rx);
+    }
+    if (packet.header.seq == rx.next_ordered_delivery &&
+        Rudp::seq_lt(packet.header.seq, rx.next_expected))
+    {
+      // In-order arrival: deliver straight from the view without buffering.
+      deliver_ordered(packet.header, packet.payload, rx);
+      ++rx.next_ordered_delivery;
+    }
+    else
+    {
+      // The ring covers the whole ACK window, so every accepted seq fits.
+      static_cast<void>(rx.ordered_reorder_buffer.insert(
+          packet.header.seq, make_owned_packet(packet)));
+    }
+    // on_packet() drains whatever this released.
+  }
+
+  void RxHandler::handle_ordered_stream(const Rudp::PacketView &packet,
+                                        std::uint32_t stream_seq,
+                                        RxSessionState &rx)
+  {
+    if (packet.header.hasFlag(Rudp::Flag::Fragment))
+    {
+      place_fragment(packet, rx);
+    }
+
+    auto &stream = rx.ordered_streams[packet.header.channel_id];
+    if (stream_seq == stream.next_delivery)
+    {
+      deliver_ordered(packet.header, packet.payload, rx);
+      ++stream.next_delivery;
+    }
+    else if (Rudp::seq_gt(stream_seq, stream.next_delivery))
+    {
+      stream.reorder_buffer.try_emplace(stream_seq, make_owned_packet(packet));
+    }
+
+    auto next = stream.reorder_buffer.find(stream.next_delivery);
+    while (next != stream.reorder_buffer.end())
+    {
+      auto packet_out = std::move(next->second);
+      stream.reorder_buffer.erase(next);
+      deliver_owned_ordered(std::move(packet_out), rx);
+      next = stream.reorder_buffer.find(++stream.next_delivery);
+    }
   }
 
   void RxHandler::handle_reliable_unordered(const Rudp::PacketView &packet,
@@ -186,13 +436,18 @@ namespace Rudp::Session
   {
     // Duplicate/stale suppression is handled by update_reliable_receive_state().
     // Packets that reach this point are eligible for immediate app delivery.
-    rx.pending_events.push_back(make_data_event(packet));
+    if (packet.header.hasFlag(Rudp::Flag::Fragment))
+    {
+      emit_reassembled(place_fragment(packet, rx), rx);
+      return;
+    }
+    push_data_events(packet.header, packet.payload, rx);
   }
 
   void RxHandler::handle_unreliable(const Rudp::PacketView &packet,
                                     RxSessionState &rx)
   {
-    rx.pending_events.push_back(make_data_event(packet));
+    push_data_events(packet.header, packet.payload, rx);
   }
 
   void RxHandler::handle_monotonic_state(const Rudp::PacketView &packet,
@@ -220,7 +475,9 @@ namespace Rudp::Session
     }
 
     rx.monotonic_versions[packet.header.channel_id] = version;
-    rx.pending_events.push_back(make_data_event(packet));
+    rx.pending_events.push_back(make_data_event(
+        packet.header,
+        std::vector<std::byte>(packet.payload.begin(), packet.payload.end())));
   }
 
 } // namespace Rudp::Session
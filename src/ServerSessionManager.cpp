@@ -1,14 +1,22 @@
 #include "Rudp/ServerSessionManager.hpp"
 
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <cstring>
 #include <functional>
-#include <random>
 
 #include "Rudp/Codec.hpp"
+#include "Rudp/Config.hpp"
 #include "Rudp/ConnectionStateMachine.hpp"
 
 namespace Rudp::Session {
 namespace {
 
+// Cookie SYN-ACKs held between two polls. SYNs past this are dropped; their
+// clients retry on their own retransmission timer.
+constexpr std::size_t kMaxQueuedCookieReplies = 1024;
+
 [[nodiscard]] std::size_t hash_combine(std::size_t seed,
                                        std::size_t value) noexcept {
   seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6U) + (seed >> 2U);
@@ -17,16 +25,105 @@ namespace {
 
 }  // namespace
 
+EndpointKey EndpointKey::ipv4(std::uint32_t host_order_address,
+                              std::uint16_t port) noexcept {
+  EndpointKey endpoint;
+  endpoint.address[0] = static_cast<std::uint8_t>(host_order_address >> 24U);
+  endpoint.address[1] = static_cast<std::uint8_t>(host_order_address >> 16U);
+  endpoint.address[2] = static_cast<std::uint8_t>(host_order_address >> 8U);
+  endpoint.address[3] = static_cast<std::uint8_t>(host_order_address);
+  endpoint.port = port;
+  endpoint.family = AddressFamily::IPv4;
+  return endpoint;
+}
+
+std::optional<EndpointKey> EndpointKey::parse(std::string_view address,
+                                              std::uint16_t port) {
+  const std::string text(address);
+  EndpointKey endpoint;
+  endpoint.port = port;
+  if (::inet_pton(AF_INET, text.c_str(), endpoint.address.data()) == 1) {
+    endpoint.family = AddressFamily::IPv4;
+    return endpoint;
+  }
+  if (::inet_pton(AF_INET6, text.c_str(), endpoint.address.data()) == 1) {
+    endpoint.family = AddressFamily::IPv6;
+    return endpoint;
+  }
+  return std::nullopt;
+}
+
+std::string EndpointKey::address_string() const {
+  char buffer[INET6_ADDRSTRLEN] = {};
+  switch (family) {
+    case AddressFamily::IPv4:
+      ::inet_ntop(AF_INET, address.data(), buffer, sizeof(buffer));
+      return buffer;
+    case AddressFamily::IPv6:
+      ::inet_ntop(AF_INET6, address.data(), buffer, sizeof(buffer));
+      return buffer;
+    case AddressFamily::Unspecified:
+      break;
+  }
+  return "unspecified";
+}
+
+std::string EndpointKey::to_string() const {
+  if (family == AddressFamily::IPv6) {
+    return '[' + address_string() + "]:" + std::to_string(port);
+  }
+  return address_string() + ':' + std::to_string(port);
+}
+
 std::size_t EndpointKeyHash::operator()(const EndpointKey& endpoint) const
     noexcept {
-  std::size_t seed = std::hash<std::string>{}(endpoint.address);
-  seed = hash_combine(seed, std::hash<std::uint16_t>{}(endpoint.port));
+  std::uint64_t high = 0;
+  std::uint64_t low = 0;
+  std::memcpy(&high, endpoint.address.data(), sizeof(high));
+  std::memcpy(&low, endpoint.address.data() + sizeof(high), sizeof(low));
+  std::size_t seed = static_cast<std::size_t>(high);
+  seed = hash_combine(seed, static_cast<std::size_t>(low));
+  seed = hash_combine(
+      seed, (static_cast<std::size_t>(endpoint.family) << 16U) | endpoint.port);
   return seed;
 }
 
+void RetiredConnIds::retire(std::uint32_t conn_id, std::uint64_t now_ms) {
+  expire(now_ms);
+  if (capacity_ == 0 || ids_.contains(conn_id)) {
+    return;
+  }
+  if (ids_.size() >= capacity_) {
+    pop_oldest();
+  }
+  ids_.insert(conn_id);
+  by_expiry_.push_back(
+      Entry{.conn_id = conn_id, .expires_at_ms = now_ms + quiet_ms_});
+}
+
+void RetiredConnIds::expire(std::uint64_t now_ms) {
+  while (!by_expiry_.empty() && by_expiry_.front().expires_at_ms <= now_ms) {
+    pop_oldest();
+  }
+}
+
+void RetiredConnIds::pop_oldest() {
+  ids_.erase(by_expiry_.front().conn_id);
+  by_expiry_.pop_front();
+}
+
+ServerSessionManager::ServerSessionManager(ConnIdAllocator conn_ids)
+    : conn_ids_(conn_ids),
+      retired_conn_ids_(
+          Rudp::Config::current().transport.retired_conn_id_quiet_ms,
+          Rudp::Config::current().transport.max_retired_conn_ids),
+      cookies_enabled_(
+          Rudp::Config::current().transport.enable_handshake_cookies) {}
+
 void ServerSessionManager::on_datagram_received(const EndpointKey& endpoint,
                                                 std::span<const std::byte> bytes,
                                                 std::uint64_t now_ms) {
+  now_ms_ = now_ms;
   const auto decoded = Rudp::Codec::decode(bytes);
   if (!decoded.has_value()) {
     return;
@@ -40,7 +137,11 @@ void ServerSessionManager::on_datagram_received(const EndpointKey& endpoint,
     return;
   }
 
-  if (!route_new_peer(endpoint, bytes, decoded->header, now_ms)) {
+  if (route_cookie_echo(endpoint, bytes, *decoded, now_ms)) {
+    return;
+  }
+
+  if (!route_new_peer(endpoint, bytes, *decoded, now_ms)) {
     // A non-zero conn_id claims to belong to an already-known connection. If
     // it did not match an active or pending route, drop it.
     return;
@@ -49,25 +150,131 @@ void ServerSessionManager::on_datagram_received(const EndpointKey& endpoint,
 
 std::vector<OutboundDatagram> ServerSessionManager::poll_tx(
     std::uint64_t now_ms) {
+  OutboundBatch batch;
+  static_cast<void>(poll_tx_batch(now_ms, 1U, batch));
+
   std::vector<OutboundDatagram> outbound;
-  std::vector<EndpointKey> pending_to_cleanup;
-  std::vector<std::pair<EndpointKey, std::uint32_t>> active_to_cleanup;
+  outbound.reserve(batch.size());
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    const auto bytes = batch.datagrams[i];
+    outbound.push_back(OutboundDatagram{
+        .endpoint = batch.endpoints[i],
+        .bytes = std::vector<std::byte>(bytes.begin(), bytes.end()),
+    });
+  }
+  return outbound;
+}
 
-  collect_pending_tx(now_ms, outbound, pending_to_cleanup);
-  collect_active_tx(now_ms, outbound, active_to_cleanup);
+std::size_t ServerSessionManager::poll_tx_batch(std::uint64_t now_ms,
+                                                std::size_t budget_per_session,
+                                                OutboundBatch& sink) {
+  now_ms_ = now_ms;
+  retired_conn_ids_.expire(now_ms);
+  polling_.clear();
+  polling_.swap(ready_);
+  ready_set_.clear();
+  timers_.advance(now_ms, polling_);
 
-  for (const auto& endpoint : pending_to_cleanup) {
-    auto pending_it = find_pending_session(endpoint);
-    if (pending_it != pending_by_endpoint_.end()) {
-      cleanup_pending_session(endpoint, pending_it);
-    }
+  std::size_t produced = cookie_replies_.size();
+  for (std::size_t i = 0; i < cookie_replies_.size(); ++i) {
+    const auto bytes = cookie_replies_.datagrams[i];
+    const auto out = sink.datagrams.prepare(bytes.size());
+    std::copy(bytes.begin(), bytes.end(), out.begin());
+    sink.datagrams.commit(bytes.size());
+    sink.endpoints.push_back(cookie_replies_.endpoints[i]);
+  }
+  cookie_replies_.clear();
+  for (const auto conn_id : polling_) {
+    produced += poll_session(conn_id, now_ms, budget_per_session, sink);
+  }
+  return produced;
+}
+
+std::optional<std::uint64_t> ServerSessionManager::next_deadline_ms(
+    std::uint64_t now_ms) const {
+  if (!ready_.empty() || !cookie_replies_.empty()) {
+    return now_ms;
+  }
+  return timers_.next_deadline_ms();
+}
+
+void ServerSessionManager::mark_ready(std::uint32_t conn_id) {
+  if (ready_set_.insert(conn_id).second) {
+    ready_.push_back(conn_id);
+  }
+  timers_.cancel(conn_id);
+}
+
+Session* ServerSessionManager::find_session_by_conn_id(std::uint32_t conn_id,
+                                                       EndpointKey& endpoint) {
+  const auto endpoint_it = endpoint_by_conn_id_.find(conn_id);
+  if (endpoint_it == endpoint_by_conn_id_.end()) {
+    return nullptr;
   }
+  endpoint = endpoint_it->second;
+
+  if (auto active_it = find_active_session(conn_id);
+      active_it != active_by_conn_id_.end()) {
+    return &sessions_[active_it->second];
+  }
+  if (auto pending_it = find_pending_session(endpoint);
+      pending_it != pending_by_endpoint_.end() &&
+      sessions_[pending_it->second].conn_id() == conn_id) {
+    return &sessions_[pending_it->second];
+  }
+  return nullptr;
+}
 
-  for (const auto& [endpoint, conn_id] : active_to_cleanup) {
+bool ServerSessionManager::cleanup_if_terminal(std::uint32_t conn_id,
+                                               const EndpointKey& endpoint,
+                                               const Session& session) {
+  if (!is_terminal_state(session.connection_state())) {
+    return false;
+  }
+  if (has_active_session(conn_id)) {
     cleanup_active_session(endpoint, conn_id);
+  } else {
+    cleanup_pending_session(endpoint, find_pending_session(endpoint));
+  }
+  return true;
+}
+
+std::size_t ServerSessionManager::poll_session(std::uint32_t conn_id,
+                                               std::uint64_t now_ms,
+                                               std::size_t budget,
+                                               OutboundBatch& sink) {
+  EndpointKey endpoint;
+  Session* session = find_session_by_conn_id(conn_id, endpoint);
+  if (session == nullptr) {
+    timers_.cancel(conn_id);
+    return 0;
   }
 
-  return outbound;
+  const auto produced = session->poll_tx_batch(now_ms, budget, sink.datagrams);
+  sink.endpoints.resize(sink.endpoints.size() + produced, endpoint);
+  if (produced == 0 && cleanup_if_terminal(conn_id, endpoint, *session)) {
+    return 0;
+  }
+
+  if (is_terminal_state(session->connection_state())) {
+    // Reaped on the next poll, once it has nothing left to send.
+    mark_ready(conn_id);
+    return produced;
+  }
+
+  const auto deadline = session->next_deadline_ms(now_ms);
+  if (!deadline.has_value()) {
+    timers_.cancel(conn_id);
+  } else if (*deadline > now_ms) {
+    timers_.schedule(conn_id, *deadline);
+  } else if (produced != 0) {
+    mark_ready(conn_id);
+  } else {
+    // Nothing came out at `now_ms` despite a due deadline; retry next tick
+    // instead of spinning.
+    timers_.schedule(conn_id, now_ms + 1U);
+  }
+  return produced;
 }
 
 bool ServerSessionManager::is_terminal_state(ConnectionState state) const
@@ -108,12 +315,20 @@ bool ServerSessionManager::route_existing_pending(
 
 bool ServerSessionManager::route_new_peer(const EndpointKey& endpoint,
                                           std::span<const std::byte> bytes,
-                                          const Rudp::Header& header,
+                                          const Rudp::PacketView& packet,
                                           std::uint64_t now_ms) {
-  if (header.conn_id != 0) {
+  if (packet.header.conn_id != 0) {
     return false;
   }
 
+  if (cookies_enabled_) {
+    if (!active_conn_id_by_endpoint_.contains(endpoint) &&
+        classify_control_kind(packet.header) == ControlKind::Syn) {
+      reply_with_cookie(endpoint, packet, now_ms);
+    }
+    return true;
+  }
+
   const auto pending_it = ensure_session_for_new_peer(endpoint);
   if (pending_it == pending_by_endpoint_.end()) {
     return false;
@@ -123,6 +338,108 @@ bool ServerSessionManager::route_new_peer(const EndpointKey& endpoint,
   return true;
 }
 
+void ServerSessionManager::reply_with_cookie(const EndpointKey& endpoint,
+                                             const Rudp::PacketView& syn,
+                                             std::uint64_t now_ms) {
+  if (cookie_replies_.size() >= kMaxQueuedCookieReplies) {
+    return;
+  }
+  const auto syn_extensions = Rudp::Codec::decode_extensions(syn.extensions);
+  if (!syn_extensions.has_value()) {
+    return;
+  }
+
+  // The conn_id is not reserved: the allocator will not offer it again this
+  // generation, and route_cookie_echo() rechecks it before use.
+  const auto conn_id = allocate_conn_id();
+  const auto issued = cookies_.issue(
+      endpoint, conn_id,
+      CookieSyn{
+          .client_isn = syn.header.seq,
+          .window = syn_extensions->window.value_or(0U),
+          .features = syn_extensions->features.value_or(0U),
+      },
+      now_ms);
+
+  auto extensions = syn_ack_extensions(*syn_extensions);
+  extensions.cookie = issued.cookie;
+  const Rudp::Header header{
+      .conn_id = conn_id,
+      .seq = issued.server_isn,
+      .ack = syn.header.seq + 1U,
+      .ack_bits = 0,
+      .channel_id = 0,
+      .channel_type = Rudp::ChannelType::Unreliable,
+      .flags = Rudp::Flag::Syn | Rudp::Flag::Ack,
+      .header_len = Rudp::kHeaderLength,
+      .reserved = 0,
+  };
+  const auto size = Rudp::Codec::encoded_size(extensions, 0U);
+  const auto written = Rudp::Codec::encode_into(
+      cookie_replies_.datagrams.prepare(size), header, extensions, {});
+  if (!written.has_value()) {
+    return;
+  }
+  cookie_replies_.datagrams.commit(*written);
+  cookie_replies_.endpoints.push_back(endpoint);
+}
+
+bool ServerSessionManager::route_cookie_echo(const EndpointKey& endpoint,
+                                             std::span<const std::byte> bytes,
+                                             const Rudp::PacketView& packet,
+                                             std::uint64_t now_ms) {
+  const auto conn_id = packet.header.conn_id;
+  if (!cookies_enabled_ || conn_id == 0 || conn_id_is_in_use(conn_id) ||
+      active_conn_id_by_endpoint_.contains(endpoint)) {
+    return false;
+  }
+  const auto extensions = Rudp::Codec::decode_extensions(packet.extensions);
+  if (!extensions.has_value() || !extensions->cookie.has_value()) {
+    return false;
+  }
+  // A client acknowledges the SYN-ACK, and thus the server ISN, with every
+  // packet until the server sends something else.
+  const auto server_isn = packet.header.ack - 1U;
+  const auto syn = cookies_.verify(
+      endpoint, conn_id, server_isn, *extensions->cookie, now_ms,
+      Rudp::Config::current().transport.idle_timeout_ms);
+  if (!syn.has_value()) {
+    return false;
+  }
+
+  Rudp::HeaderExtensions syn_extensions;
+  if (syn->window != 0) {
+    syn_extensions.window = syn->window;
+  }
+  if (syn->features != 0) {
+    syn_extensions.features = syn->features;
+  }
+  const Rudp::PacketView syn_view{
+      .header =
+          Rudp::Header{
+              .conn_id = 0,
+              .seq = syn->client_isn,
+              .ack = 0,
+              .ack_bits = 0,
+              .channel_id = 0,
+              .channel_type = Rudp::ChannelType::Unreliable,
+              .flags = static_cast<Rudp::Flags>(Rudp::Flag::Syn),
+              .header_len = Rudp::kHeaderLength,
+              .reserved = 0,
+          },
+      .payload = {},
+      .extensions = {},
+  };
+  const auto handle = sessions_.emplace(SessionRole::Server, server_isn);
+  active_by_conn_id_.emplace(conn_id, handle);
+  auto& session = sessions_[handle];
+  session.assign_conn_id(conn_id);
+  session.resume_handshake(syn_view, syn_extensions, now_ms);
+  endpoint_by_conn_id_[conn_id] = endpoint;
+  active_conn_id_by_endpoint_[endpoint] = conn_id;
+  return try_dispatch_active(endpoint, bytes, conn_id, now_ms);
+}
+
 bool ServerSessionManager::try_dispatch_active(const EndpointKey& endpoint,
                                                std::span<const std::byte> bytes,
                                                std::uint32_t conn_id,
@@ -132,7 +449,8 @@ bool ServerSessionManager::try_dispatch_active(const EndpointKey& endpoint,
     return false;
   }
 
-  active_it->second.on_datagram_received(bytes, now_ms);
+  sessions_[active_it->second].on_datagram_received(bytes, now_ms);
+  mark_ready(conn_id);
   cleanup_active_if_terminal(endpoint, conn_id, active_it);
   return true;
 }
@@ -145,8 +463,10 @@ bool ServerSessionManager::try_dispatch_pending(const EndpointKey& endpoint,
     return false;
   }
 
-  pending_it->second.on_datagram_received(bytes, now_ms);
-  const auto state = pending_it->second.connection_state();
+  auto& session = sessions_[pending_it->second];
+  session.on_datagram_received(bytes, now_ms);
+  mark_ready(session.conn_id());
+  const auto state = session.connection_state();
   if (state == ConnectionState::Established) {
     promote_pending_session(endpoint, pending_it);
     return true;
@@ -161,7 +481,7 @@ void ServerSessionManager::cleanup_pending_if_terminal(
   if (pending_it == pending_by_endpoint_.end()) {
     return;
   }
-  if (!is_terminal_state(pending_it->second.connection_state())) {
+  if (!is_terminal_state(sessions_[pending_it->second].connection_state())) {
     return;
   }
   cleanup_pending_session(endpoint, pending_it);
@@ -174,57 +494,12 @@ void ServerSessionManager::cleanup_active_if_terminal(
   if (active_it == active_by_conn_id_.end()) {
     return;
   }
-  if (!is_terminal_state(active_it->second.connection_state())) {
+  if (!is_terminal_state(sessions_[active_it->second].connection_state())) {
     return;
   }
   cleanup_active_session(endpoint, conn_id);
 }
 
-void ServerSessionManager::collect_pending_tx(
-    std::uint64_t now_ms,
-    std::vector<OutboundDatagram>& outbound,
-    std::vector<EndpointKey>& pending_to_cleanup) {
-  for (auto& [endpoint, session] : pending_by_endpoint_) {
-    auto bytes = session.poll_tx(now_ms);
-    if (bytes.has_value()) {
-      outbound.push_back(OutboundDatagram{
-          .endpoint = endpoint,
-          .bytes = std::move(*bytes),
-      });
-      continue;
-    }
-
-    if (is_terminal_state(session.connection_state())) {
-      pending_to_cleanup.push_back(endpoint);
-    }
-  }
-}
-
-void ServerSessionManager::collect_active_tx(
-    std::uint64_t now_ms,
-    std::vector<OutboundDatagram>& outbound,
-    std::vector<std::pair<EndpointKey, std::uint32_t>>& active_to_cleanup) {
-  for (const auto& [endpoint, conn_id] : active_conn_id_by_endpoint_) {
-    auto active_it = find_active_session(conn_id);
-    if (active_it == active_by_conn_id_.end()) {
-      continue;
-    }
-
-    auto bytes = active_it->second.poll_tx(now_ms);
-    if (bytes.has_value()) {
-      outbound.push_back(OutboundDatagram{
-          .endpoint = endpoint,
-          .bytes = std::move(*bytes),
-      });
-      continue;
-    }
-
-    if (is_terminal_state(active_it->second.connection_state())) {
-      active_to_cleanup.push_back({endpoint, conn_id});
-    }
-  }
-}
-
 ServerSessionManager::PendingMap::iterator
 ServerSessionManager::find_pending_session(const EndpointKey& endpoint) {
   return pending_by_endpoint_.find(endpoint);
@@ -251,7 +526,7 @@ std::optional<std::uint32_t> ServerSessionManager::pending_conn_id(
   if (it == pending_by_endpoint_.end()) {
     return std::nullopt;
   }
-  return it->second.conn_id();
+  return sessions_[it->second].conn_id();
 }
 
 std::optional<std::uint32_t> ServerSessionManager::active_conn_id(
@@ -269,7 +544,7 @@ std::optional<ConnectionState> ServerSessionManager::pending_connection_state(
   if (it == pending_by_endpoint_.end()) {
     return std::nullopt;
   }
-  return it->second.connection_state();
+  return sessions_[it->second].connection_state();
 }
 
 std::optional<SessionStats> ServerSessionManager::active_stats(
@@ -278,7 +553,7 @@ std::optional<SessionStats> ServerSessionManager::active_stats(
   if (it == active_by_conn_id_.end()) {
     return std::nullopt;
   }
-  return it->second.stats();
+  return sessions_[it->second].stats();
 }
 
 std::vector<SessionEvent> ServerSessionManager::drain_active_events(
@@ -287,7 +562,7 @@ std::vector<SessionEvent> ServerSessionManager::drain_active_events(
   if (it == active_by_conn_id_.end()) {
     return {};
   }
-  return it->second.drain_events();
+  return sessions_[it->second].drain_events();
 }
 
 bool ServerSessionManager::queue_send(std::uint32_t conn_id,
@@ -299,14 +574,31 @@ bool ServerSessionManager::queue_send(std::uint32_t conn_id,
     return false;
   }
 
-  it->second.queue_send(channel_id, channel_type, payload);
+  sessions_[it->second].queue_send(channel_id, channel_type, payload);
+  mark_ready(conn_id);
+  return true;
+}
+
+bool ServerSessionManager::queue_send(std::uint32_t conn_id,
+                                      std::uint32_t channel_id,
+                                      Rudp::ChannelType channel_type,
+                                      std::vector<std::byte>&& payload) {
+  const auto it = find_active_session(conn_id);
+  if (it == active_by_conn_id_.end()) {
+    return false;
+  }
+
+  sessions_[it->second].queue_send(channel_id, channel_type,
+                                   std::move(payload));
+  mark_ready(conn_id);
   return true;
 }
 
 std::vector<ServerSessionEvent> ServerSessionManager::drain_events() {
   std::vector<ServerSessionEvent> events;
 
-  for (auto& [endpoint, session] : pending_by_endpoint_) {
+  for (const auto& [endpoint, handle] : pending_by_endpoint_) {
+    auto& session = sessions_[handle];
     auto drained = session.drain_events();
     for (auto& event : drained) {
       events.push_back(ServerSessionEvent{
@@ -325,7 +617,7 @@ std::vector<ServerSessionEvent> ServerSessionManager::drain_events() {
       continue;
     }
 
-    auto drained = it->second.drain_events();
+    auto drained = sessions_[it->second].drain_events();
     for (auto& event : drained) {
       events.push_back(ServerSessionEvent{
           .endpoint = endpoint,
@@ -361,8 +653,12 @@ ServerSessionManager::ensure_session_for_new_peer(const EndpointKey& endpoint) {
   }
 
   pending_it =
-      pending_by_endpoint_.try_emplace(endpoint, SessionRole::Server).first;
-  pending_it->second.assign_conn_id(allocate_conn_id());
+      pending_by_endpoint_
+          .emplace(endpoint, sessions_.emplace(SessionRole::Server))
+          .first;
+  const auto conn_id = allocate_conn_id();
+  sessions_[pending_it->second].assign_conn_id(conn_id);
+  endpoint_by_conn_id_[conn_id] = endpoint;
   return pending_it;
 }
 
@@ -373,13 +669,13 @@ void ServerSessionManager::promote_pending_session(
     return;
   }
 
-  const auto conn_id = pending_it->second.conn_id();
+  const auto conn_id = sessions_[pending_it->second].conn_id();
   if (conn_id == 0) {
     return;
   }
 
   active_conn_id_by_endpoint_[endpoint] = conn_id;
-  active_by_conn_id_.insert_or_assign(conn_id, std::move(pending_it->second));
+  active_by_conn_id_.insert_or_assign(conn_id, pending_it->second);
   pending_by_endpoint_.erase(pending_it);
 }
 
@@ -390,19 +686,28 @@ void ServerSessionManager::cleanup_pending_session(
   if (pending_it == pending_by_endpoint_.end()) {
     return;
   }
-  const auto conn_id = pending_it->second.conn_id();
+  const auto conn_id = sessions_[pending_it->second].conn_id();
   if (conn_id != 0) {
-    retired_conn_ids_.insert(conn_id);
+    retired_conn_ids_.retire(conn_id, now_ms_);
+    endpoint_by_conn_id_.erase(conn_id);
+    timers_.cancel(conn_id);
   }
+  sessions_.erase(pending_it->second);
   pending_by_endpoint_.erase(pending_it);
 }
 
 void ServerSessionManager::cleanup_active_session(const EndpointKey& endpoint,
                                                   std::uint32_t conn_id) {
   if (conn_id != 0) {
-    retired_conn_ids_.insert(conn_id);
+    retired_conn_ids_.retire(conn_id, now_ms_);
+  }
+  if (const auto active_it = active_by_conn_id_.find(conn_id);
+      active_it != active_by_conn_id_.end()) {
+    sessions_.erase(active_it->second);
+    active_by_conn_id_.erase(active_it);
   }
-  active_by_conn_id_.erase(conn_id);
+  endpoint_by_conn_id_.erase(conn_id);
+  timers_.cancel(conn_id);
   const auto endpoint_it = active_conn_id_by_endpoint_.find(endpoint);
   if (endpoint_it != active_conn_id_by_endpoint_.end() &&
       endpoint_it->second == conn_id) {
@@ -420,28 +725,16 @@ bool ServerSessionManager::conn_id_is_in_use(std::uint32_t conn_id) const
     return true;
   }
 
-  if (active_by_conn_id_.find(conn_id) != active_by_conn_id_.end()) {
-    return true;
-  }
-
-  for (const auto& [endpoint, session] : pending_by_endpoint_) {
-    (void)endpoint;
-    if (session.conn_id() == conn_id) {
-      return true;
-    }
-  }
-
-  return false;
+  // Every live session, pending or active, has an endpoint_by_conn_id_ entry.
+  return endpoint_by_conn_id_.contains(conn_id);
 }
 
 std::uint32_t ServerSessionManager::allocate_conn_id() {
-  std::random_device rd;
-
+  // The allocator does not repeat an id within a generation, so this only
+  // loops after it wraps onto an id that is still live or retired.
   std::uint32_t value = 0;
   do {
-    const auto upper = static_cast<std::uint32_t>(rd()) << 16U;
-    const auto lower = static_cast<std::uint32_t>(rd()) & 0xffffU;
-    value = upper ^ lower;
+    value = conn_ids_.next();
   } while (conn_id_is_in_use(value));
 
   return value;
@@ -76,6 +76,23 @@ void adopt_server_conn_id(SessionState& state, const Rudp::Header& header) {
   state.conn_id = header.conn_id;
 }
 
+// A client keeps the cookie of the SYN-ACK that completes its handshake and
+// drops it on the first other packet from the server.
+void track_handshake_cookie(SessionState& state,
+                            ControlKind control_kind,
+                            const Rudp::HeaderExtensions& extensions) {
+  if (state.role != SessionRole::Client) {
+    return;
+  }
+  if (control_kind == ControlKind::SynAck) {
+    if (state.connection_state == ConnectionState::HandshakeSent) {
+      state.tx.handshake_cookie = extensions.cookie;
+    }
+    return;
+  }
+  state.tx.handshake_cookie.reset();
+}
+
 void reset_for_conn_id_mismatch(SessionState& state) {
   state.connection_state = ConnectionState::Reset;
   emit_local_error(state.rx, "conn_id mismatch");
@@ -94,14 +111,87 @@ void schedule_final_ack_during_linger(SessionState& state,
 
 void apply_remote_ack(TxHandler& tx_handler,
                       const Rudp::Header& header,
+                      const Rudp::HeaderExtensions& extensions,
                       ControlKind control_kind,
+                      std::uint64_t now_ms,
                       TxAckResult& ack_result,
                       TxSessionState& tx) {
   if (!should_apply_remote_ack(control_kind)) {
     return;
   }
 
-  ack_result = tx_handler.on_remote_ack(header.ack, header.ack_bits, tx);
+  ack_result = tx_handler.on_remote_ack(header.ack, header.ack_bits,
+                                        extensions.sacks(), now_ms, tx);
+}
+
+// SYN and SYN-ACK carry the sender's receive window. A peer that sends none
+// is held to the v1.1 window, and a server only advertises its own window
+// back to a client that advertised first.
+void apply_remote_window(SessionState& state,
+                         ControlKind control_kind,
+                         const Rudp::HeaderExtensions& extensions) {
+  if (control_kind != ControlKind::Syn && control_kind != ControlKind::SynAck) {
+    return;
+  }
+
+  constexpr auto kDefaultWindow =
+      static_cast<std::uint32_t>(Rudp::kReliableWindowSize);
+  const auto remote_window = extensions.window.value_or(kDefaultWindow);
+  state.tx.send_window = std::clamp(remote_window, kDefaultWindow,
+                                    state.rx.receive_window);
+  if (control_kind == ControlKind::Syn) {
+    state.tx.advertise_window = extensions.window.has_value() &&
+                                state.rx.receive_window > kDefaultWindow;
+  }
+}
+
+// SYN and SYN-ACK also carry the FEATURES bits each side offers. A feature is
+// used only when both offered it; a server answers with its own bits only to
+// a client that sent some.
+void apply_remote_features(SessionState& state,
+                           ControlKind control_kind,
+                           const Rudp::HeaderExtensions& extensions) {
+  if (control_kind != ControlKind::Syn && control_kind != ControlKind::SynAck) {
+    return;
+  }
+
+  const auto max_datagram_bytes =
+      Rudp::Config::current().transport.max_datagram_bytes;
+  const auto agreed = state.tx.local_features & extensions.features.value_or(0);
+  state.tx.bundle_max_datagram_bytes =
+      (agreed & Rudp::kFeatureBundle) != 0 ? max_datagram_bytes : 0U;
+  state.tx.fragment_slice_size =
+      (agreed & Rudp::kFeatureFragment) != 0
+          ? Rudp::Codec::fragment_slice_size(max_datagram_bytes)
+          : 0U;
+  state.tx.ordered_streams_agreed =
+      (agreed & Rudp::kFeatureOrderedStreams) != 0;
+  if (control_kind == ControlKind::Syn) {
+    state.tx.advertise_features =
+        extensions.features.has_value() && state.tx.local_features != 0;
+  }
+}
+
+[[nodiscard]] std::uint32_t configured_features() {
+  const auto& transport = Rudp::Config::current().transport;
+  std::uint32_t features = 0;
+  if (transport.enable_bundling) {
+    features |= Rudp::kFeatureBundle;
+  }
+  if (transport.enable_fragmentation) {
+    features |= Rudp::kFeatureFragment;
+  }
+  if (transport.enable_ordered_streams) {
+    features |= Rudp::kFeatureOrderedStreams;
+  }
+  return features;
+}
+
+[[nodiscard]] std::uint32_t configured_window() {
+  return std::clamp(
+      Rudp::Config::current().transport.reliable_window_packets,
+      static_cast<std::uint32_t>(Rudp::kReliableWindowSize),
+      static_cast<std::uint32_t>(Rudp::kMaxReliableWindowSize));
 }
 
 [[nodiscard]] bool should_close_after_fin_acknowledgement(
@@ -184,6 +274,44 @@ void emit_connection_decision_events(RxSessionState& rx,
          state.last_rx_ms + Rudp::Config::current().transport.idle_timeout_ms;
 }
 
+void keep_earliest(std::optional<std::uint64_t>& deadline,
+                   std::uint64_t candidate) {
+  if (!deadline.has_value() || candidate < *deadline) {
+    deadline = candidate;
+  }
+}
+
+// Mirrors the guards in the should_schedule_*() / should_timeout_*() helpers
+// above so the earliest timer matches what poll_tx() would act on.
+[[nodiscard]] std::optional<std::uint64_t> next_session_timer_ms(
+    const SessionState& state) {
+  if (state.connection_state != ConnectionState::Established) {
+    return std::nullopt;
+  }
+
+  const auto& transport = Rudp::Config::current().transport;
+  std::optional<std::uint64_t> deadline =
+      state.last_rx_ms + transport.idle_timeout_ms;
+  const bool lane_busy = state.tx.ack_only_pending ||
+                         state.tx.probe.ping_pending ||
+                         state.tx.probe.pong_pending;
+  if (state.tx.reliable_ack_pending && !lane_busy) {
+    keep_earliest(deadline, state.tx.reliable_ack_due_ms);
+  }
+  if (transport.enable_activity_ack_only && state.tx.activity_ack_pending &&
+      !lane_busy) {
+    keep_earliest(deadline, state.last_tx_ms + transport.keepalive_idle_ms);
+  }
+  if (state.role == SessionRole::Client && !state.tx.probe.ping_outstanding &&
+      !lane_busy) {
+    const auto probe_baseline =
+        state.tx.probe.last_sent_ms != 0 ? state.tx.probe.last_sent_ms
+                                         : state.established_since_ms;
+    keep_earliest(deadline, probe_baseline + transport.keepalive_idle_ms);
+  }
+  return deadline;
+}
+
 void mark_idle_timeout(SessionState& state) {
   state.connection_state = ConnectionState::Reset;
   emit_local_error(state.rx, "idle timeout");
@@ -229,15 +357,13 @@ void record_received_stats(SessionState& state,
 }
 
 void record_outbound_stats(SessionState& state,
-                           const Rudp::PacketView& packet,
-                           std::size_t datagram_size,
-                           std::uint64_t now_ms,
-                           bool is_retransmission) {
+                           const TxPollResult& result,
+                           std::uint64_t now_ms) {
   state.last_tx_ms = now_ms;
   ++state.stats.packets_sent;
-  state.stats.bytes_sent += datagram_size;
+  state.stats.bytes_sent += result.written;
 
-  const auto control_kind = classify_control_kind(packet.header);
+  const auto control_kind = result.control_kind;
   if (control_kind != ControlKind::None) {
     ++state.stats.control_packets_sent;
   } else {
@@ -250,7 +376,7 @@ void record_outbound_stats(SessionState& state,
     ++state.stats.pongs_sent;
   }
 
-  if (is_retransmission) {
+  if (result.retransmission) {
     ++state.stats.retransmissions_sent;
   }
 }
@@ -275,19 +401,11 @@ void clear_outbound_ack_state(SessionState& state, ControlKind control_kind) {
 }
 
 void apply_outbound_result(SessionState& state,
-                           const std::vector<std::byte>& datagram,
-                           std::uint64_t now_ms,
-                           bool is_retransmission) {
-  const auto decoded = Rudp::Codec::decode(datagram);
-  if (!decoded.has_value()) {
-    return;
-  }
-
-  const auto control_kind = classify_control_kind(decoded->header);
-  update_outbound_probe_state(state, control_kind, now_ms);
-  record_outbound_stats(state, *decoded, datagram.size(), now_ms,
-                        is_retransmission);
-  clear_outbound_ack_state(state, control_kind);
+                           const TxPollResult& result,
+                           std::uint64_t now_ms) {
+  update_outbound_probe_state(state, result.control_kind, now_ms);
+  record_outbound_stats(state, result, now_ms);
+  clear_outbound_ack_state(state, result.control_kind);
 }
 
 void handle_probe_receive(SessionState& state,
@@ -345,6 +463,21 @@ void schedule_receive_side_ack(SessionState& state,
 
 }  // namespace
 
+Rudp::HeaderExtensions syn_ack_extensions(
+    const Rudp::HeaderExtensions& syn_extensions) {
+  Rudp::HeaderExtensions extensions;
+  const auto window = configured_window();
+  if (syn_extensions.window.has_value() &&
+      window > Rudp::kReliableWindowSize) {
+    extensions.window = window;
+  }
+  const auto features = configured_features();
+  if (syn_extensions.features.has_value() && features != 0) {
+    extensions.features = features;
+  }
+  return extensions;
+}
+
 Session::Session(SessionRole role) : Session(role, generate_initial_seq()) {}
 
 Session::Session(SessionRole role, std::uint32_t initial_seq)
@@ -361,8 +494,22 @@ Session::Session(SessionRole role, std::uint32_t initial_seq)
                   .next_seq = initial_seq,
                   .remote_ack = initial_seq,
                   .remote_ack_bits = 0,
-                  .pending_send = {},
-                  .inflight = {},
+                  .send_window =
+                      static_cast<std::uint32_t>(Rudp::kReliableWindowSize),
+                  .advertise_window = false,
+                  .local_features = configured_features(),
+                  .advertise_features = false,
+                  .handshake_cookie = std::nullopt,
+                  .bundle_max_datagram_bytes = 0,
+                  .fragment_slice_size = 0,
+                  .ordered_streams_agreed = false,
+                  .next_stream_seq = {},
+                  .send_queues = {},
+                  .send_turn = 0,
+                  .send_turn_credited = false,
+                  .pending_send_count = 0,
+                  .max_payload_size = 0,
+                  .inflight = SeqRing<TxEntry>(configured_window()),
                   .syn_ack_pending = false,
                   .final_ack_pending = false,
                   .final_ack_linger_until_ms = 0,
@@ -372,9 +519,25 @@ Session::Session(SessionRole role, std::uint32_t initial_seq)
                   .reliable_ack_due_ms = 0,
                   .activity_ack_pending = false,
                   .probe = {},
+                  .rtt = {},
+                  .congestion = CongestionController(
+                      Rudp::Config::current().transport.congestion_control),
+                  .pacer = Pacer(
+                      Rudp::Config::current().transport.pacing_burst_packets),
               },
           .rx = {},
-      }) {}
+      }) {
+  const auto window = configured_window();
+  state_.tx.advertise_window =
+      role == SessionRole::Client && window > Rudp::kReliableWindowSize;
+  state_.tx.advertise_features =
+      role == SessionRole::Client && state_.tx.local_features != 0;
+  state_.rx.receive_window = window;
+  state_.rx.received_beyond = SeqBitset(window);
+  state_.rx.ordered_reorder_buffer = SeqRing<OwnedPacket>(window + 1U);
+  state_.rx.max_reassembly_bytes =
+      Rudp::Config::current().transport.max_reassembly_bytes;
+}
 
 void Session::queue_send(std::uint32_t channel_id,
                          Rudp::ChannelType channel_type,
@@ -382,35 +545,106 @@ void Session::queue_send(std::uint32_t channel_id,
   tx_handler_.queue_app_data(channel_id, channel_type, payload, state_.tx);
 }
 
+void Session::queue_send(std::uint32_t channel_id,
+                         Rudp::ChannelType channel_type,
+                         std::vector<std::byte>&& payload) {
+  tx_handler_.queue_app_data(channel_id, channel_type, std::move(payload),
+                             state_.tx);
+}
+
 std::optional<std::vector<std::byte>> Session::poll_tx(std::uint64_t now_ms) {
-  if (should_timeout_idle_session(state_, now_ms)) {
-    mark_idle_timeout(state_);
+  if (!prepare_poll(now_ms)) {
     return std::nullopt;
   }
 
-  schedule_pending_tx_work(state_, now_ms);
-
   auto result =
       tx_handler_.poll(now_ms, state_.role, state_.conn_id,
                        state_.connection_state, state_.rx, state_.tx);
-  if (result.fatal_error) {
-    state_.connection_state = ConnectionState::Reset;
-    emit_local_error(state_.rx, std::move(result.error_message));
+  if (!finish_poll(result)) {
     return std::nullopt;
   }
   if (result.datagram.has_value()) {
-    apply_outbound_result(state_, *result.datagram, now_ms,
-                          result.retransmission);
+    apply_outbound_result(state_, result, now_ms);
   }
   return result.datagram;
 }
 
+std::optional<std::size_t> Session::poll_tx_into(std::span<std::byte> buffer,
+                                                 std::uint64_t now_ms) {
+  if (!prepare_poll(now_ms)) {
+    return std::nullopt;
+  }
+
+  auto result =
+      tx_handler_.poll_into(buffer, now_ms, state_.role, state_.conn_id,
+                            state_.connection_state, state_.rx, state_.tx);
+  if (!finish_poll(result) || result.written == 0) {
+    return std::nullopt;
+  }
+  apply_outbound_result(state_, result, now_ms);
+  return result.written;
+}
+
+std::size_t Session::poll_tx_batch(std::uint64_t now_ms,
+                                   std::size_t budget,
+                                   DatagramArena& sink) {
+  std::size_t produced = 0;
+  while (produced < budget) {
+    const auto written =
+        poll_tx_into(sink.prepare(max_datagram_size()), now_ms);
+    if (!written.has_value()) {
+      break;
+    }
+    sink.commit(*written);
+    ++produced;
+  }
+  return produced;
+}
+
+std::size_t Session::max_datagram_size() const noexcept {
+  return std::max(Rudp::kMaxHeaderLength + state_.tx.max_payload_size,
+                  state_.tx.bundle_max_datagram_bytes);
+}
+
+bool Session::prepare_poll(std::uint64_t now_ms) {
+  if (should_timeout_idle_session(state_, now_ms)) {
+    mark_idle_timeout(state_);
+    return false;
+  }
+
+  schedule_pending_tx_work(state_, now_ms);
+  return true;
+}
+
+bool Session::finish_poll(TxPollResult& result) {
+  if (result.fatal_error) {
+    state_.connection_state = ConnectionState::Reset;
+    emit_local_error(state_.rx, std::move(result.error_message));
+    return false;
+  }
+  return true;
+}
+
+std::optional<std::uint64_t> Session::next_deadline_ms(
+    std::uint64_t now_ms) const {
+  auto deadline = tx_handler_.next_deadline_ms(
+      now_ms, state_.role, state_.connection_state, state_.tx);
+  if (const auto timer = next_session_timer_ms(state_); timer.has_value()) {
+    keep_earliest(deadline, *timer);
+  }
+  return deadline;
+}
+
 void Session::on_datagram_received(std::span<const std::byte> bytes,
                                    std::uint64_t now_ms) {
   const auto decoded = Rudp::Codec::decode(bytes);
   if (!decoded.has_value()) {
     return;
   }
+  const auto extensions = Rudp::Codec::decode_extensions(decoded->extensions);
+  if (!extensions.has_value()) {
+    return;
+  }
 
   const auto control_kind = classify_control_kind(decoded->header);
   record_received_stats(state_, *decoded, control_kind, bytes.size(), now_ms);
@@ -428,12 +662,15 @@ void Session::on_datagram_received(std::span<const std::byte> bytes,
     schedule_final_ack_during_linger(state_, now_ms);
     return;
   }
+  track_handshake_cookie(state_, control_kind, *extensions);
 
   handle_probe_receive(state_, control_kind, now_ms);
+  apply_remote_window(state_, control_kind, *extensions);
+  apply_remote_features(state_, control_kind, *extensions);
 
   TxAckResult ack_result{};
-  apply_remote_ack(tx_handler_, decoded->header, control_kind, ack_result,
-                   state_.tx);
+  apply_remote_ack(tx_handler_, decoded->header, *extensions, control_kind,
+                   now_ms, ack_result, state_.tx);
   if (should_close_after_fin_acknowledgement(state_, ack_result)) {
     close_after_fin_acknowledgement(state_, *decoded);
   }
@@ -441,7 +678,8 @@ void Session::on_datagram_received(std::span<const std::byte> bytes,
       state_.role, state_.connection_state, control_kind);
   apply_connection_decision(*decoded, decision);
   const auto rx_result =
-      rx_handler_.on_packet(*decoded, now_ms, control_kind, state_.rx);
+      rx_handler_.on_packet(*decoded, *extensions, now_ms, control_kind,
+                            state_.rx);
 
   update_post_receive_liveness(state_, control_kind);
   schedule_receive_side_ack(state_, *decoded, control_kind, rx_result, now_ms);
@@ -477,6 +715,23 @@ void Session::apply_connection_decision(const Rudp::PacketView& packet,
   emit_connection_decision_events(state_.rx, packet, decision);
 }
 
+void Session::resume_handshake(const Rudp::PacketView& syn,
+                               const Rudp::HeaderExtensions& syn_extensions,
+                               std::uint64_t now_ms) {
+  apply_remote_window(state_, ControlKind::Syn, syn_extensions);
+  apply_remote_features(state_, ControlKind::Syn, syn_extensions);
+  static_cast<void>(rx_handler_.on_packet(syn, syn_extensions, now_ms,
+                                          ControlKind::Syn, state_.rx));
+  // The SYN-ACK went out statelessly with initial_seq and has been
+  // acknowledged, so it never enters the inflight ring.
+  ++state_.tx.next_seq;
+  state_.tx.remote_ack = state_.tx.next_seq;
+  state_.connection_state = ConnectionState::Established;
+  state_.established_since_ms = now_ms;
+  state_.last_rx_ms = now_ms;
+  emit_control_event(state_.rx, SessionEvent::Type::Connected, syn);
+}
+
 void Session::request_close() {
   if (state_.connection_state == ConnectionState::Established) {
     state_.connection_state = ConnectionState::Closing;
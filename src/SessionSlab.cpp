@@ -0,0 +1,33 @@
+#include "Rudp/SessionSlab.hpp"
+
+namespace Rudp::Session {
+
+void SessionSlab::erase(Handle handle) noexcept {
+  auto& freed = slot(handle);
+  if (!freed.session.has_value()) {
+    return;
+  }
+  freed.session.reset();
+  freed.next_free = free_head_;
+  free_head_ = handle;
+  --size_;
+}
+
+SessionSlab::Handle SessionSlab::acquire_slot() {
+  if (free_head_ == kNoSlot) {
+    // Thread the new chunk onto the free list back to front, so its slots
+    // are handed out in address order.
+    const auto first = static_cast<Handle>(capacity());
+    chunks_.push_back(std::make_unique<Chunk>());
+    auto& chunk = *chunks_.back();
+    for (std::size_t i = kChunkSlots; i-- > 0;) {
+      chunk[i].next_free = free_head_;
+      free_head_ = first + static_cast<Handle>(i);
+    }
+  }
+  const auto handle = free_head_;
+  free_head_ = slot(handle).next_free;
+  return handle;
+}
+
+}  // namespace Rudp::Session
@@ -0,0 +1,190 @@
+#include "Rudp/TimerWheel.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace Rudp::Session {
+namespace {
+
+[[nodiscard]] constexpr std::uint64_t level_granularity(std::size_t level) {
+  return std::uint64_t{1} << (6U * level);
+}
+
+[[nodiscard]] constexpr std::uint64_t level_span(std::size_t level) {
+  return std::uint64_t{1} << (6U * (level + 1U));
+}
+
+[[nodiscard]] constexpr std::size_t slot_index(std::uint64_t time_ms,
+                                               std::size_t level) {
+  return static_cast<std::size_t>((time_ms >> (6U * level)) & 63U);
+}
+
+}  // namespace
+
+void TimerWheel::schedule(std::uint32_t id, std::uint64_t deadline_ms) {
+  const auto [it, inserted] = deadlines_.try_emplace(id, deadline_ms);
+  if (!inserted) {
+    if (it->second == deadline_ms) {
+      return;
+    }
+    // The old slot entry becomes stale and is dropped when reached.
+    it->second = deadline_ms;
+  }
+  place(Entry{.id = id, .deadline_ms = deadline_ms});
+}
+
+void TimerWheel::cancel(std::uint32_t id) { deadlines_.erase(id); }
+
+std::optional<std::uint64_t> TimerWheel::deadline_of(std::uint32_t id) const
+    noexcept {
+  const auto it = deadlines_.find(id);
+  if (it == deadlines_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+bool TimerWheel::is_live(const Entry& entry) const noexcept {
+  const auto it = deadlines_.find(entry.id);
+  return it != deadlines_.end() && it->second == entry.deadline_ms;
+}
+
+void TimerWheel::place(const Entry& entry) {
+  if (entry.deadline_ms <= current_ms_) {
+    due_.push_back(entry);
+    return;
+  }
+
+  const auto delta = entry.deadline_ms - current_ms_;
+  for (std::size_t level = 0; level < kLevels; ++level) {
+    if (delta < level_span(level)) {
+      const auto index = slot_index(entry.deadline_ms, level);
+      levels_[level][index].push_back(entry);
+      occupied_[level] |= std::uint64_t{1} << index;
+      return;
+    }
+  }
+
+  // Beyond the wheel's range: park in the farthest top-level slot and let the
+  // cascade re-place it with its real deadline.
+  constexpr auto top = kLevels - 1U;
+  const auto index = slot_index(current_ms_ + level_span(top) - 1U, top);
+  levels_[top][index].push_back(entry);
+  occupied_[top] |= std::uint64_t{1} << index;
+}
+
+void TimerWheel::cascade(std::size_t level) {
+  const auto index = slot_index(current_ms_, level);
+  if ((occupied_[level] & (std::uint64_t{1} << index)) == 0) {
+    return;
+  }
+
+  Slot entries;
+  entries.swap(levels_[level][index]);
+  occupied_[level] &= ~(std::uint64_t{1} << index);
+  for (const auto& entry : entries) {
+    if (is_live(entry)) {
+      place(entry);
+    }
+  }
+  // Hand the allocation back so the slot does not regrow from scratch.
+  entries.clear();
+  if (levels_[level][index].empty()) {
+    levels_[level][index].swap(entries);
+  }
+}
+
+void TimerWheel::expire_slot(std::size_t index,
+                             std::vector<std::uint32_t>& expired) {
+  if ((occupied_[0] & (std::uint64_t{1} << index)) == 0) {
+    return;
+  }
+
+  auto& slot = levels_[0][index];
+  for (const auto& entry : slot) {
+    if (is_live(entry)) {
+      deadlines_.erase(entry.id);
+      expired.push_back(entry.id);
+    }
+  }
+  slot.clear();
+  occupied_[0] &= ~(std::uint64_t{1} << index);
+}
+
+void TimerWheel::collect_due(std::vector<std::uint32_t>& expired) {
+  for (const auto& entry : due_) {
+    if (is_live(entry)) {
+      deadlines_.erase(entry.id);
+      expired.push_back(entry.id);
+    }
+  }
+  due_.clear();
+}
+
+void TimerWheel::advance(std::uint64_t now_ms,
+                         std::vector<std::uint32_t>& expired) {
+  collect_due(expired);
+
+  while (current_ms_ < now_ms) {
+    // Levels below the first occupied one have nothing to expire or cascade,
+    // so jump straight to the tick before that level's next slot boundary.
+    std::uint64_t skip_span = 1;
+    std::size_t empty_levels = 0;
+    while (empty_levels < kLevels && occupied_[empty_levels] == 0) {
+      skip_span = level_span(empty_levels);
+      ++empty_levels;
+    }
+    if (empty_levels == kLevels) {
+      current_ms_ = now_ms;
+      break;
+    }
+    if (skip_span > 1U) {
+      const auto boundary = (current_ms_ / skip_span + 1U) * skip_span;
+      current_ms_ = std::min(now_ms, boundary - 1U);
+      if (current_ms_ == now_ms) {
+        break;
+      }
+    }
+
+    ++current_ms_;
+    // Cascade from the top down so entries can fall through several levels
+    // on the same tick.
+    for (std::size_t level = kLevels - 1U; level > 0U; --level) {
+      if (current_ms_ % level_granularity(level) == 0U) {
+        cascade(level);
+      }
+    }
+    collect_due(expired);
+    expire_slot(slot_index(current_ms_, 0), expired);
+  }
+}
+
+std::optional<std::uint64_t> TimerWheel::next_deadline_ms() const noexcept {
+  if (deadlines_.empty()) {
+    return std::nullopt;
+  }
+  if (!due_.empty()) {
+    return current_ms_;
+  }
+
+  std::optional<std::uint64_t> earliest;
+  for (std::size_t level = 0; level < kLevels; ++level) {
+    if (occupied_[level] == 0) {
+      continue;
+    }
+    const auto granularity = level_granularity(level);
+    const auto period = current_ms_ / granularity;
+    const auto current_index = static_cast<unsigned>(period & 63U);
+    // Rotate so bit 0 is the slot right after the current one.
+    const auto rotated =
+        std::rotr(occupied_[level], static_cast<int>(current_index + 1U));
+    const auto distance = static_cast<std::uint64_t>(std::countr_zero(rotated)) + 1U;
+    const auto slot_time = (period + distance) * granularity;
+    if (!earliest.has_value() || slot_time < *earliest) {
+      earliest = slot_time;
+    }
+  }
+  return earliest;
+}
+
+}  // namespace Rudp::Session
@@ -1,8 +1,10 @@
 #include "Rudp/Config.hpp"
+#include "Rudp/ConnectionStateMachine.hpp"
 #include "Rudp/TxHandler.hpp"
 
 #include <algorithm>
 #include <bit>
+#include <limits>
 #include <utility>
 
 namespace Rudp::Session {
@@ -12,26 +14,6 @@ constexpr std::uint32_t kInternalProbeChannelId = 0;
 constexpr Rudp::ChannelType kInternalProbeChannelType =
     Rudp::ChannelType::Unreliable;
 
-[[nodiscard]] bool is_acknowledged_by_remote(std::uint32_t seq,
-                                             std::uint32_t ack,
-                                             std::uint64_t ack_bits) {
-  if (Rudp::seq_lt(seq, ack)) {
-    return true;
-  }
-
-  if (!Rudp::seq_gt(seq, ack)) {
-    return false;
-  }
-
-  const std::uint32_t distance = seq - ack;
-  if (distance == 0 || distance > Rudp::kAckBitsWindow) {
-    return false;
-  }
-
-  const auto bit_index = static_cast<unsigned>(distance - 1U);
-  return (ack_bits & (1ULL << bit_index)) != 0;
-}
-
 [[nodiscard]] std::vector<std::byte> copy_payload(
     std::span<const std::byte> payload) {
   return std::vector<std::byte>(payload.begin(), payload.end());
@@ -42,13 +24,40 @@ constexpr Rudp::ChannelType kInternalProbeChannelType =
          (flags & static_cast<Rudp::Flags>(Rudp::Flag::Fin)) != 0;
 }
 
-[[nodiscard]] std::uint64_t retransmit_timeout_for(std::uint32_t retry_count) {
+[[nodiscard]] std::uint64_t retransmit_timeout_for(const TxSessionState& tx,
+                                                  std::uint32_t retry_count) {
   const auto& transport = Rudp::Config::current().transport;
+  const auto base_rto =
+      tx.rtt.rto_ms != 0 ? tx.rtt.rto_ms : transport.initial_rto_ms;
   const auto clamped_retry_count = std::min<std::uint32_t>(retry_count, 4U);
-  const auto rto = transport.initial_rto_ms << clamped_retry_count;
+  const auto rto = base_rto << clamped_retry_count;
   return std::min(rto, transport.max_rto_ms);
 }
 
+// RFC 6298 section 2 with alpha = 1/8, beta = 1/4, K = 4 and a 1 ms clock.
+void update_rtt_estimate(std::uint64_t sample_ms, TxSessionState& tx) {
+  constexpr std::uint64_t kClockGranularityUs = 1000;
+  const auto& transport = Rudp::Config::current().transport;
+  const auto sample_us = sample_ms * 1000U;
+  auto& rtt = tx.rtt;
+
+  if (rtt.rto_ms == 0) {
+    rtt.srtt_us = sample_us;
+    rtt.rttvar_us = sample_us / 2U;
+  } else {
+    const auto deviation = rtt.srtt_us > sample_us ? rtt.srtt_us - sample_us
+                                                   : sample_us - rtt.srtt_us;
+    rtt.rttvar_us = (3U * rtt.rttvar_us + deviation) / 4U;
+    rtt.srtt_us = (7U * rtt.srtt_us + sample_us) / 8U;
+  }
+
+  const auto rto_us =
+      rtt.srtt_us + std::max(kClockGranularityUs, 4U * rtt.rttvar_us);
+  const auto rto_ms = (rto_us + 999U) / 1000U;
+  rtt.rto_ms =
+      std::min(std::max(rto_ms, transport.min_rto_ms), transport.max_rto_ms);
+}
+
 [[nodiscard]] Header make_internal_probe_header(std::uint32_t conn_id,
                                                 Rudp::Flags flags,
                                                 const RxSessionState& rx) {
@@ -62,90 +71,407 @@ constexpr Rudp::ChannelType kInternalProbeChannelType =
   return header;
 }
 
-[[nodiscard]] TxPollResult make_poll_result(
-    std::optional<std::vector<std::byte>> datagram,
-    bool retransmission = false) {
-  return TxPollResult{
-      .datagram = std::move(datagram),
-      .fatal_error = false,
-      .retransmission = retransmission,
-      .error_message = {},
-  };
+void append_sack_ranges(const RxSessionState& rx,
+                        Rudp::HeaderExtensions& extensions) {
+  if (!rx.received_beyond.any()) {
+    return;
+  }
+
+  // received_beyond holds seqs past the AckBits bitmap, up to the window.
+  const std::uint32_t first =
+      rx.next_expected + static_cast<std::uint32_t>(Rudp::kAckBitsWindow) + 1U;
+  const std::uint32_t limit = rx.next_expected + rx.receive_window + 1U;
+  auto begin = rx.received_beyond.find(first, limit, true);
+  while (begin != limit && extensions.sack_range_count < Rudp::kMaxSackRanges) {
+    const auto end = rx.received_beyond.find(begin, limit, false);
+    extensions.sack_ranges[extensions.sack_range_count++] =
+        Rudp::SackRange{.begin = begin, .end = end};
+    begin = rx.received_beyond.find(end, limit, true);
+  }
+}
+
+// Builds the TLVs for an outbound header from current state, so retransmits
+// carry fresh SACK ranges just like their Ack/AckBits. `stream_seq` is the
+// only per-packet TLV and is passed in by the caller.
+[[nodiscard]] Rudp::HeaderExtensions make_extensions(
+    const Header& header,
+    const RxSessionState& rx,
+    const TxSessionState& tx,
+    std::optional<std::uint32_t> stream_seq = std::nullopt) {
+  Rudp::HeaderExtensions extensions;
+  extensions.stream_seq = stream_seq;
+  if (header.hasFlag(Rudp::Flag::Syn) && tx.advertise_window) {
+    extensions.window = rx.receive_window;
+  }
+  if (header.hasFlag(Rudp::Flag::Syn) && tx.advertise_features) {
+    extensions.features = tx.local_features;
+  }
+  extensions.cookie = tx.handshake_cookie;
+  append_sack_ranges(rx, extensions);
+  return extensions;
+}
+
+void release_acknowledged_entry(std::uint32_t seq,
+                                std::uint64_t now_ms,
+                                TxSessionState& tx,
+                                TxAckResult& result) {
+  const auto* entry = tx.inflight.find(seq);
+  if (entry == nullptr) {
+    return;
+  }
+  if (entry->packet.header.hasFlag(Rudp::Flag::Fin)) {
+    result.acknowledged_fin = true;
+  }
+  tx.congestion.on_packet_acked(entry->delivery, now_ms);
+  // Karn's rule: an ACK for a retransmitted packet is ambiguous.
+  if (entry->retry_count == 0 && now_ms >= entry->first_send_ms) {
+    const auto sample = now_ms - entry->first_send_ms;
+    if (!result.rtt_sample_ms.has_value() || sample < *result.rtt_sample_ms) {
+      result.rtt_sample_ms = sample;
+    }
+  }
+  tx.inflight.erase(seq);
 }
 
+// Only seqs below the cumulative ACK, named by a set AckBits bit or covered by
+// a SACK range can be released, so walk those directly instead of testing
+// every inflight entry.
 void erase_acknowledged_inflight(std::uint32_t ack,
                                  std::uint64_t ack_bits,
+                                 std::span<const Rudp::SackRange> sack_ranges,
+                                 std::uint64_t now_ms,
                                  TxSessionState& tx,
                                  TxAckResult& result) {
-  for (auto it = tx.inflight.begin(); it != tx.inflight.end();) {
-    if (!is_acknowledged_by_remote(it->first, ack, ack_bits)) {
-      ++it;
-      continue;
+  while (!tx.inflight.empty() && Rudp::seq_lt(tx.inflight.front_seq(), ack)) {
+    release_acknowledged_entry(tx.inflight.front_seq(), now_ms, tx, result);
+  }
+
+  for (auto bits = ack_bits; bits != 0ULL; bits &= bits - 1U) {
+    const auto distance = static_cast<std::uint32_t>(std::countr_zero(bits)) + 1U;
+    release_acknowledged_entry(ack + distance, now_ms, tx, result);
+  }
+
+  for (const auto& range : sack_ranges) {
+    // A range can never cover more seqs than the inflight ring holds.
+    const auto length = std::min<std::uint32_t>(
+        range.end - range.begin,
+        static_cast<std::uint32_t>(tx.inflight.capacity()));
+    for (std::uint32_t i = 0; i < length && !tx.inflight.empty(); ++i) {
+      release_acknowledged_entry(range.begin + i, now_ms, tx, result);
     }
+  }
+}
 
-    if (it->second.packet.header.hasFlag(Rudp::Flag::Fin)) {
-      result.acknowledged_fin = true;
+// Highest seq the peer reports as received past the cumulative ACK, if any.
+[[nodiscard]] std::optional<std::uint32_t> highest_selectively_acked(
+    std::uint32_t ack,
+    std::uint64_t ack_bits,
+    std::span<const Rudp::SackRange> sack_ranges) {
+  std::optional<std::uint32_t> highest;
+  if (ack_bits != 0ULL) {
+    const auto highest_bit =
+        63U - static_cast<unsigned>(std::countl_zero(ack_bits));
+    highest = ack + highest_bit + 1U;
+  }
+  for (const auto& range : sack_ranges) {
+    if (range.end == range.begin) {
+      continue;
+    }
+    const std::uint32_t last = range.end - 1U;
+    if (!highest.has_value() || Rudp::seq_gt(last, *highest)) {
+      highest = last;
     }
-    it = tx.inflight.erase(it);
   }
+  return highest;
 }
 
-void mark_gap_fast_retransmit_candidates(std::uint32_t ack,
-                                         std::uint64_t ack_bits,
-                                         TxSessionState& tx) {
-  if (ack_bits == 0ULL) {
+// Runs after acknowledged entries are erased, so every inflight seq below the
+// highest selectively acked one is a gap the peer has seen past.
+void mark_gap_fast_retransmit_candidates(
+    std::uint32_t ack,
+    std::uint64_t ack_bits,
+    std::span<const Rudp::SackRange> sack_ranges,
+    std::uint64_t now_ms,
+    TxSessionState& tx) {
+  const auto highest_acked_seq =
+      highest_selectively_acked(ack, ack_bits, sack_ranges);
+  if (!highest_acked_seq.has_value()) {
     return;
   }
 
-  const auto highest_bit =
-      63U - static_cast<unsigned>(std::countl_zero(ack_bits));
-  const std::uint32_t highest_acked_seq = ack + highest_bit + 1U;
   const auto threshold =
       Rudp::Config::current().transport.fast_retx_evidence_threshold;
-
-  for (std::uint32_t seq = ack; Rudp::seq_le(seq, highest_acked_seq); ++seq) {
-    if (is_acknowledged_by_remote(seq, ack, ack_bits)) {
-      continue;
+  for (auto [seq, entry] : tx.inflight) {
+    if (!Rudp::seq_lt(seq, *highest_acked_seq)) {
+      break;
     }
-
-    auto it = tx.inflight.find(seq);
-    if (it == tx.inflight.end()) {
-      continue;
+    ++entry.gap_evidence_count;
+    if (entry.gap_evidence_count >= threshold && !entry.fast_retx_pending) {
+      entry.fast_retx_pending = true;
+      tx.congestion.on_fast_loss(seq, tx.next_seq, now_ms);
     }
+  }
+}
+
+[[nodiscard]] bool reliable_window_full(const TxSessionState& tx) {
+  return (tx.next_seq - tx.remote_ack) >= tx.send_window;
+}
+
+// Congestion control only paces new reliable data; retransmissions and
+// handshake/FIN control packets are never held back by it.
+[[nodiscard]] bool congestion_window_full(const TxSessionState& tx) {
+  return !tx.congestion.can_send(tx.inflight.size());
+}
+
+// A fixed rate wins; otherwise BbrLite paces at its bandwidth estimate and
+// window-based controllers at cwnd / SRTT, with Linux TCP's gains (faster in
+// slow start so pacing never caps the window's growth).
+[[nodiscard]] std::optional<double> pacing_rate_for(const TxSessionState& tx) {
+  const auto& transport = Rudp::Config::current().transport;
+  if (!transport.enable_pacing) {
+    return std::nullopt;
+  }
+  if (transport.pacing_rate_pps != 0) {
+    return static_cast<double>(transport.pacing_rate_pps);
+  }
+  const auto& congestion = tx.congestion;
+  if (const auto bottleneck = congestion.bottleneck_rate();
+      bottleneck.has_value()) {
+    return *bottleneck * 1.25;
+  }
+  if (congestion.algorithm() == Rudp::Config::CongestionControl::None ||
+      tx.rtt.rto_ms == 0) {
+    return std::nullopt;
+  }
+  // Sub-millisecond paths round SRTT to 0; pace them as if it were 1 ms.
+  const auto srtt_s =
+      static_cast<double>(std::max<std::uint64_t>(tx.rtt.srtt_us, 1000U)) /
+      1'000'000.0;
+  const double gain = congestion.in_slow_start() ? 2.0 : 1.2;
+  return gain * static_cast<double>(congestion.window_packets()) / srtt_s;
+}
+
+[[nodiscard]] bool has_handshake_work(SessionRole role,
+                                      ConnectionState connection_state,
+                                      const TxSessionState& tx) {
+  return (role == SessionRole::Client &&
+          connection_state == ConnectionState::Closed) ||
+         (tx.syn_ack_pending &&
+          connection_state == ConnectionState::HandshakeReceived) ||
+         (tx.final_ack_pending &&
+          connection_state == ConnectionState::Established) ||
+         (tx.fin_pending && connection_state == ConnectionState::Closing);
+}
+
+// A closed window only holds back reliable queues; unreliable ones behind
+// them keep sending.
+[[nodiscard]] bool queue_sendable(const ChannelQueue& queue,
+                                  bool reliable_blocked) {
+  return !queue.pending.empty() &&
+         !(reliable_blocked &&
+           Rudp::isReliableChannel(queue.pending.front().channel_type));
+}
+
+[[nodiscard]] bool reliable_blocked(const TxSessionState& tx) {
+  return reliable_window_full(tx) || congestion_window_full(tx);
+}
+
+[[nodiscard]] bool has_sendable_fresh_data(const TxSessionState& tx) {
+  if (tx.pending_send_count == 0) {
+    return false;
+  }
+  const bool blocked = reliable_blocked(tx);
+  return std::ranges::any_of(tx.send_queues, [&](const ChannelQueue& queue) {
+    return queue_sendable(queue, blocked);
+  });
+}
 
-    ++it->second.gap_evidence_count;
-    if (it->second.gap_evidence_count >= threshold) {
-      it->second.fast_retx_pending = true;
+// Deficit round-robin among the sendable queues of the best priority. A
+// queue is credited weight * max_datagram_bytes when the turn reaches it and
+// keeps the turn while its deficit is positive. Sending debits the payload
+// bytes, so each queue's share follows its weight whatever its message sizes.
+[[nodiscard]] ChannelQueue* select_send_queue(TxSessionState& tx) {
+  const bool blocked = reliable_blocked(tx);
+  auto& queues = tx.send_queues;
+  const auto best = std::ranges::find_if(queues, [&](const ChannelQueue& queue) {
+    return queue_sendable(queue, blocked);
+  });
+  if (best == queues.end()) {
+    return nullptr;
+  }
+  const auto priority = best->priority;
+  const auto quantum = static_cast<std::int64_t>(std::max<std::size_t>(
+      Rudp::Config::current().transport.max_datagram_bytes, 1U));
+
+  // Ends within a few laps: each one credits every eligible queue.
+  for (;;) {
+    if (tx.send_turn >= queues.size()) {
+      tx.send_turn = 0;
+      tx.send_turn_credited = false;
     }
+    auto& queue = queues[tx.send_turn];
+    if (queue.priority == priority && queue_sendable(queue, blocked)) {
+      if (!tx.send_turn_credited) {
+        queue.deficit += quantum * static_cast<std::int64_t>(queue.weight);
+        tx.send_turn_credited = true;
+      }
+      if (queue.deficit > 0) {
+        return &queue;
+      }
+    }
+    ++tx.send_turn;
+    tx.send_turn_credited = false;
   }
 }
 
-[[nodiscard]] bool reliable_window_full(const TxSessionState& tx) {
-  return (tx.next_seq - tx.remote_ack) >= Rudp::kReliableWindowSize;
+// Finds the channel's queue, creating it with its configured schedule.
+[[nodiscard]] ChannelQueue& channel_queue(std::uint32_t channel_id,
+                                          TxSessionState& tx) {
+  auto& queues = tx.send_queues;
+  const auto found =
+      std::ranges::find(queues, channel_id, &ChannelQueue::channel_id);
+  if (found != queues.end()) {
+    return *found;
+  }
+
+  ChannelQueue queue;
+  queue.channel_id = channel_id;
+  for (const auto& schedule :
+       Rudp::Config::current().transport.channel_schedules) {
+    if (schedule.channel_id == channel_id) {
+      queue.priority = schedule.priority;
+      queue.weight = std::max(schedule.weight, 1U);
+      break;
+    }
+  }
+  const auto position =
+      std::ranges::find_if(queues, [&](const ChannelQueue& other) {
+        return std::pair(other.priority, other.channel_id) >
+               std::pair(queue.priority, channel_id);
+      });
+  // Keep the turn on the queue that held it.
+  if (!queues.empty() &&
+      static_cast<std::size_t>(position - queues.begin()) <= tx.send_turn) {
+    ++tx.send_turn;
+  }
+  return *queues.insert(position, std::move(queue));
 }
 
 }  // namespace
 
+// Destination of the datagram a poll builds: the caller's buffer for
+// poll_into(), or a vector sized to fit for poll(). Builders check fits()
+// before changing any state, so a datagram that does not fit stays queued.
+class DatagramOutput final {
+ public:
+  explicit DatagramOutput(std::span<std::byte> buffer) noexcept
+      : buffer_(buffer) {}
+  explicit DatagramOutput(std::vector<std::byte>& owned) noexcept
+      : owned_(&owned) {}
+
+  [[nodiscard]] bool fits(std::size_t size) noexcept {
+    if (owned_ != nullptr || size <= buffer_.size()) {
+      return true;
+    }
+    required_size_ = size;
+    return false;
+  }
+
+  void encode(const Header& header,
+              const Rudp::HeaderExtensions& extensions,
+              std::span<const std::byte> payload) {
+    const auto size = Rudp::Codec::encoded_size(extensions, payload.size());
+    static_cast<void>(Rudp::Codec::encode_into(
+        reserve(header, payload.size(), size), header, extensions, payload));
+  }
+
+  [[nodiscard]] std::size_t written() const noexcept { return written_; }
+  [[nodiscard]] std::size_t required_size() const noexcept {
+    return required_size_;
+  }
+
+  // Result for the datagram just written, described from the header it was
+  // built from rather than by decoding the bytes.
+  [[nodiscard]] TxPollResult result(bool retransmission = false) const {
+    return TxPollResult{
+        .datagram = std::nullopt,
+        .written = written_,
+        .required_size = 0,
+        .fatal_error = false,
+        .retransmission = retransmission,
+        .error_message = {},
+        .header = header_,
+        .control_kind = classify_control_kind(header_),
+        .payload_size = payload_size_,
+    };
+  }
+
+ private:
+  [[nodiscard]] std::span<std::byte> reserve(const Header& header,
+                                             std::size_t payload_size,
+                                             std::size_t size) {
+    header_ = header;
+    payload_size_ = payload_size;
+    written_ = size;
+    if (owned_ != nullptr) {
+      owned_->resize(size);
+      return *owned_;
+    }
+    return buffer_.first(size);
+  }
+
+  std::span<std::byte> buffer_;
+  std::vector<std::byte>* owned_ = nullptr;
+  Header header_{};
+  std::size_t payload_size_ = 0;
+  std::size_t written_ = 0;
+  std::size_t required_size_ = 0;
+};
+
 void TxHandler::queue_app_data(std::uint32_t channel_id,
                                Rudp::ChannelType channel_type,
                                std::span<const std::byte> payload,
                                TxSessionState& tx) {
-  tx.pending_send.push_back(SendRequest{
+  queue_app_data(channel_id, channel_type, copy_payload(payload), tx);
+}
+
+void TxHandler::queue_app_data(std::uint32_t channel_id,
+                               Rudp::ChannelType channel_type,
+                               std::vector<std::byte>&& payload,
+                               TxSessionState& tx) {
+  tx.max_payload_size = std::max(tx.max_payload_size, payload.size());
+  channel_queue(channel_id, tx).pending.push_back(SendRequest{
       .channel_id = channel_id,
       .channel_type = channel_type,
-      .payload = copy_payload(payload),
+      .payload = std::move(payload),
   });
+  ++tx.pending_send_count;
 }
 
 TxAckResult TxHandler::on_remote_ack(std::uint32_t ack,
                                      std::uint64_t ack_bits,
+                                     std::uint64_t now_ms,
                                      TxSessionState& tx) {
+  return on_remote_ack(ack, ack_bits, {}, now_ms, tx);
+}
+
+TxAckResult TxHandler::on_remote_ack(
+    std::uint32_t ack,
+    std::uint64_t ack_bits,
+    std::span<const Rudp::SackRange> sack_ranges,
+    std::uint64_t now_ms,
+    TxSessionState& tx) {
   TxAckResult result{};
   tx.remote_ack = ack;
   tx.remote_ack_bits = ack_bits;
 
-  erase_acknowledged_inflight(ack, ack_bits, tx, result);
-  mark_gap_fast_retransmit_candidates(ack, ack_bits, tx);
+  erase_acknowledged_inflight(ack, ack_bits, sack_ranges, now_ms, tx, result);
+  if (result.rtt_sample_ms.has_value()) {
+    update_rtt_estimate(*result.rtt_sample_ms, tx);
+  }
+  tx.congestion.on_ack_processed(ack, result.rtt_sample_ms, tx.rtt.srtt_us,
+                                 now_ms);
+  mark_gap_fast_retransmit_candidates(ack, ack_bits, sack_ranges, now_ms, tx);
   return result;
 }
 
@@ -155,143 +481,235 @@ TxPollResult TxHandler::poll(std::uint64_t now_ms,
                              ConnectionState& connection_state,
                              const RxSessionState& rx,
                              TxSessionState& tx) {
-  if (auto bytes =
-          try_build_handshake(now_ms, role, conn_id, connection_state, rx, tx);
-      bytes.has_value()) {
-    return make_poll_result(std::move(bytes));
+  std::vector<std::byte> bytes;
+  DatagramOutput output(bytes);
+  auto result =
+      poll_output(output, now_ms, role, conn_id, connection_state, rx, tx);
+  if (result.written != 0) {
+    result.datagram = std::move(bytes);
   }
+  return result;
+}
 
-  if (auto result = try_build_retransmit(now_ms, rx, tx);
-      result.fatal_error || result.datagram.has_value()) {
+TxPollResult TxHandler::poll_into(std::span<std::byte> buffer,
+                                  std::uint64_t now_ms,
+                                  SessionRole role,
+                                  std::uint32_t conn_id,
+                                  ConnectionState& connection_state,
+                                  const RxSessionState& rx,
+                                  TxSessionState& tx) {
+  DatagramOutput output(buffer);
+  return poll_output(output, now_ms, role, conn_id, connection_state, rx, tx);
+}
+
+TxPollResult TxHandler::poll_output(DatagramOutput& output,
+                                    std::uint64_t now_ms,
+                                    SessionRole role,
+                                    std::uint32_t conn_id,
+                                    ConnectionState& connection_state,
+                                    const RxSessionState& rx,
+                                    TxSessionState& tx) {
+  tx.pacer.set_rate(pacing_rate_for(tx), now_ms);
+
+  // Stop at the first datagram that does not fit rather than sending
+  // something of lower priority in its place.
+  const auto too_small = [&output] {
+    TxPollResult result;
+    result.required_size = output.required_size();
     return result;
-  }
+  };
 
-  if (auto bytes = try_build_probe_lane(conn_id, rx, tx); bytes.has_value()) {
-    return make_poll_result(std::move(bytes));
+  if (try_build_handshake(output, now_ms, role, conn_id, connection_state, rx,
+                          tx)) {
+    return output.result();
+  }
+  if (output.required_size() != 0) {
+    return too_small();
   }
 
-  if (auto bytes = try_build_ack_only(conn_id, rx, tx); bytes.has_value()) {
-    return make_poll_result(std::move(bytes));
+  if (auto result = try_build_retransmit(output, now_ms, rx, tx);
+      result.fatal_error || result.written != 0) {
+    return result;
+  }
+  if (output.required_size() != 0) {
+    return too_small();
   }
 
-  if (auto bytes = try_build_fresh(now_ms, conn_id, rx, tx);
-      bytes.has_value()) {
-    return make_poll_result(std::move(bytes));
+  if (try_build_probe_lane(output, conn_id, rx, tx) ||
+      try_build_ack_only(output, conn_id, rx, tx) ||
+      try_build_fresh(output, now_ms, conn_id, rx, tx)) {
+    return output.result();
+  }
+  if (output.required_size() != 0) {
+    return too_small();
   }
 
   return {};
 }
 
-  std::optional<std::vector<std::byte>> TxHandler::try_build_handshake(
-      std::uint64_t now_ms,
-      SessionRole role,
-      std::uint32_t conn_id,
-      ConnectionState &connection_state,
-      const RxSessionState &rx,
-      TxSessionState &tx)
+std::optional<std::uint64_t> TxHandler::next_deadline_ms(
+    std::uint64_t now_ms,
+    SessionRole role,
+    ConnectionState connection_state,
+    const TxSessionState& tx) const {
+  if (has_handshake_work(role, connection_state, tx) ||
+      tx.probe.pong_pending || tx.probe.ping_pending || tx.ack_only_pending) {
+    return now_ms;
+  }
+  // Data packets, fresh or retransmitted, wait for a pacing token.
+  const auto paced_ms = tx.pacer.next_send_ms(now_ms);
+  if (has_sendable_fresh_data(tx)) {
+    return paced_ms;
+  }
+
+  const auto max_retransmit_count =
+      Rudp::Config::current().transport.max_retransmit_count;
+  std::optional<std::uint64_t> deadline;
+  for (auto [seq, entry] : tx.inflight) {
+    static_cast<void>(seq);
+    if (entry.retry_count >= max_retransmit_count) {
+      return now_ms;
+    }
+    if (entry.fast_retx_pending) {
+      return paced_ms;
+    }
+    const auto retransmit_at = std::max(
+        entry.last_send_ms + retransmit_timeout_for(tx, entry.retry_count),
+        paced_ms);
+    if (!deadline.has_value() || retransmit_at < *deadline) {
+      deadline = retransmit_at;
+    }
+  }
+  return deadline;
+}
+
+  bool TxHandler::try_build_handshake(DatagramOutput &output,
+                                      std::uint64_t now_ms,
+                                      SessionRole role,
+                                      std::uint32_t conn_id,
+                                      ConnectionState &connection_state,
+                                      const RxSessionState &rx,
+                                      TxSessionState &tx)
   {
     if (role == SessionRole::Client &&
         connection_state == ConnectionState::Closed) {
-      connection_state = ConnectionState::HandshakeSent;
-      return build_control_packet(now_ms, conn_id,
-                                  static_cast<Rudp::Flags>(Rudp::Flag::Syn),
-                                  rx, tx);
+      if (build_control_packet(output, now_ms, conn_id,
+                               static_cast<Rudp::Flags>(Rudp::Flag::Syn), rx,
+                               tx))
+      {
+        connection_state = ConnectionState::HandshakeSent;
+        return true;
+      }
+      return false;
     }
 
     if (tx.syn_ack_pending &&
         connection_state == ConnectionState::HandshakeReceived) {
-      if (auto packet = build_control_packet(
-              now_ms, conn_id, Rudp::Flag::Syn | Rudp::Flag::Ack, rx, tx);
-          packet.has_value())
+      if (build_control_packet(output, now_ms, conn_id,
+                               Rudp::Flag::Syn | Rudp::Flag::Ack, rx, tx))
       {
         tx.syn_ack_pending = false;
-        return packet;
+        return true;
       }
-      return std::nullopt;
+      return false;
     }
 
     if (tx.final_ack_pending &&
         connection_state == ConnectionState::Established) {
-      if (auto packet = build_control_packet(
-              now_ms, conn_id, static_cast<Rudp::Flags>(Rudp::Flag::Ack), rx,
-              tx);
-          packet.has_value())
+      if (build_control_packet(output, now_ms, conn_id,
+                               static_cast<Rudp::Flags>(Rudp::Flag::Ack), rx,
+                               tx))
       {
         tx.final_ack_pending = false;
         tx.final_ack_linger_until_ms =
             now_ms + Rudp::Config::current().transport.handshake_linger_ms;
-        return packet;
+        return true;
       }
-      return std::nullopt;
+      return false;
     }
 
     if (tx.fin_pending && connection_state == ConnectionState::Closing) {
-      if (auto packet = build_control_packet(
-              now_ms, conn_id,
-              static_cast<Rudp::Flags>(Rudp::Flag::Fin), rx, tx);
-          packet.has_value())
+      if (build_control_packet(output, now_ms, conn_id,
+                               static_cast<Rudp::Flags>(Rudp::Flag::Fin), rx,
+                               tx))
       {
         tx.fin_pending = false;
-        return packet;
+        return true;
       }
-      return std::nullopt;
+      return false;
     }
 
-    return std::nullopt;
+    return false;
   }
 
-  TxPollResult TxHandler::try_build_retransmit(std::uint64_t now_ms,
+  TxPollResult TxHandler::try_build_retransmit(DatagramOutput &output,
+                                               std::uint64_t now_ms,
                                                const RxSessionState &rx,
                                                TxSessionState &tx)
   {
     for (auto it = tx.inflight.begin(); it != tx.inflight.end();)
     {
-      auto &[seq, entry] = *it;
-      static_cast<void>(seq);
+      auto [seq, entry] = *it;
 
       if (entry.retry_count >=
           Rudp::Config::current().transport.max_retransmit_count) {
         tx.inflight.erase(it);
         return TxPollResult{
             .datagram = std::nullopt,
+            .written = 0,
+            .required_size = 0,
             .fatal_error = true,
             .retransmission = false,
             .error_message = "retransmission retry limit exceeded",
         };
       }
 
-      const auto current_rto_ms = retransmit_timeout_for(entry.retry_count);
+      const auto current_rto_ms = retransmit_timeout_for(tx, entry.retry_count);
       const bool timed_out = now_ms >= entry.last_send_ms + current_rto_ms;
       if (!entry.fast_retx_pending && !timed_out) {
         ++it;
         continue;
       }
+      if (!tx.pacer.can_send(now_ms)) {
+        return {};
+      }
 
       auto header = entry.packet.header;
       header.ack = rx.next_expected;
       header.ack_bits = rx.received_bits;
+      // Extensions are rebuilt too, so retransmits carry fresh SACK ranges.
+      const auto extensions = make_extensions(header, rx, tx, entry.stream_seq);
+      if (!output.fits(Rudp::Codec::encoded_size(
+              extensions, entry.packet.payload.size()))) {
+        return {};
+      }
+      if (!entry.fast_retx_pending) {
+        tx.congestion.on_retransmit_timeout(seq, tx.next_seq, now_ms);
+      }
+
       // Ack/AckBits from RX state are copied into every outbound header here.
       entry.packet.header.ack = header.ack;
       entry.packet.header.ack_bits = header.ack_bits;
+      output.encode(entry.packet.header, extensions, entry.packet.payload);
 
-      auto encoded = Rudp::Codec::encode(header, entry.packet.payload);
+      tx.pacer.on_sent(now_ms);
       entry.last_send_ms = now_ms;
       ++entry.retry_count;
       entry.gap_evidence_count = 0;
       entry.fast_retx_pending = false;
-      return make_poll_result(std::move(encoded), true);
+      return output.result(true);
     }
 
     return {};
   }
 
-  std::optional<std::vector<std::byte>> TxHandler::try_build_ack_only(
-      std::uint32_t conn_id,
-      const RxSessionState &rx,
-      TxSessionState &tx)
+  bool TxHandler::try_build_ack_only(DatagramOutput &output,
+                                     std::uint32_t conn_id,
+                                     const RxSessionState &rx,
+                                     TxSessionState &tx)
   {
     if (!tx.ack_only_pending) {
-      return std::nullopt;
+      return false;
     }
 
     Header header{};
@@ -303,107 +721,244 @@ TxPollResult TxHandler::poll(std::uint64_t now_ms,
     // Pure ACK packets do not carry payload but still use the ACK control flag
     // so receivers do not treat them as empty application data.
 
+    const auto extensions = make_extensions(header, rx, tx);
+    if (!output.fits(Rudp::Codec::encoded_size(extensions, 0U))) {
+      return false;
+    }
     tx.ack_only_pending = false;
-    return Rudp::Codec::encode(header, {});
+    output.encode(header, extensions, {});
+    return true;
   }
 
-  std::optional<std::vector<std::byte>> TxHandler::try_build_fresh(
-      std::uint64_t now_ms,
-      std::uint32_t conn_id,
-      const RxSessionState &rx,
-      TxSessionState &tx)
+  bool TxHandler::try_build_fresh(DatagramOutput &output,
+                                  std::uint64_t now_ms,
+                                  std::uint32_t conn_id,
+                                  const RxSessionState &rx,
+                                  TxSessionState &tx)
   {
-    if (tx.pending_send.empty()) {
-      return std::nullopt;
+    if (tx.pending_send_count == 0 || !tx.pacer.can_send(now_ms)) {
+      return false;
+    }
+    ChannelQueue *queue = select_send_queue(tx);
+    if (queue == nullptr) {
+      return false;
     }
 
-    const SendRequest request = std::move(tx.pending_send.front());
-    tx.pending_send.pop_front();
-
+    const SendRequest &request = queue->pending.front();
     const bool assign_reliable_seq =
         Rudp::isReliableChannel(request.channel_type);
-    if (assign_reliable_seq && reliable_window_full(tx)) {
-      tx.pending_send.push_front(request);
-      return std::nullopt;
+    auto header = make_header_from_request(request, conn_id, rx, tx,
+                                           assign_reliable_seq);
+    std::optional<std::uint32_t> stream_seq;
+    if (tx.ordered_streams_agreed &&
+        request.channel_type == Rudp::ChannelType::ReliableOrdered)
+    {
+      const auto it = tx.next_stream_seq.find(request.channel_id);
+      stream_seq = it != tx.next_stream_seq.end() ? it->second : 0U;
+    }
+    const auto extensions = make_extensions(header, rx, tx, stream_seq);
+    std::span<const std::byte> payload = request.payload;
+    std::size_t consumed = 1;
+    bool scratch_payload = false;
+    const auto fragment_bytes = gather_fragment(*queue, header.seq, tx);
+    if (fragment_bytes != 0) {
+      header.flags |= static_cast<Rudp::Flags>(Rudp::Flag::Fragment);
+      payload = payload_scratch_;
+      scratch_payload = true;
+      const bool last_fragment =
+          queue->front_fragment_offset + fragment_bytes ==
+          request.payload.size();
+      consumed = last_fragment ? 1U : 0U;
+    } else if (const auto bundled = gather_bundle(extensions, *queue, tx);
+               bundled > 1) {
+      header.flags |= static_cast<Rudp::Flags>(Rudp::Flag::Bundle);
+      payload = payload_scratch_;
+      scratch_payload = true;
+      consumed = bundled;
+    }
+    if (!output.fits(Rudp::Codec::encoded_size(extensions, payload.size()))) {
+      return false;
     }
 
-    OwnedPacket packet =
-        make_packet_from_request(request, conn_id, rx, tx, assign_reliable_seq);
-    auto encoded = Rudp::Codec::encode(packet.header, packet.payload);
-
+    // The only copy of the message bytes: from the queue (or the bundle /
+    // fragment scratch) into the output.
+    output.encode(header, extensions, payload);
+    const auto payload_size = payload.size();
     if (assign_reliable_seq) {
+      ++tx.next_seq;
+      // The inflight entry takes over the bytes for retransmission. A whole
+      // message leaves the queue by move; a scratch payload hands over its
+      // buffer.
+      auto owned = scratch_payload ? std::exchange(payload_scratch_, {})
+                                   : std::move(queue->pending.front().payload);
       TxEntry entry{
-          .packet = packet,
+          .packet = OwnedPacket{.header = header, .payload = std::move(owned)},
           .first_send_ms = now_ms,
           .last_send_ms = now_ms,
           .retry_count = 0,
           .gap_evidence_count = 0,
           .fast_retx_pending = false,
+          .delivery = tx.congestion.delivery_stamp(now_ms),
+          .stream_seq = stream_seq,
       };
-      tx.inflight.emplace(entry.packet.header.seq, std::move(entry));
+      tx.inflight.emplace(header.seq, std::move(entry));
+    }
+    if (stream_seq.has_value()) {
+      tx.next_stream_seq[request.channel_id] = *stream_seq + 1U;
     }
 
-    return encoded;
+    if (fragment_bytes != 0) {
+      queue->front_fragment_offset =
+          consumed != 0 ? 0U : queue->front_fragment_offset + fragment_bytes;
+    }
+    queue->deficit -= static_cast<std::int64_t>(payload_size);
+    for (std::size_t i = 0; i < consumed; ++i) {
+      queue->pending.pop_front();
+    }
+    tx.pending_send_count -= consumed;
+    if (queue->pending.empty()) {
+      // An idle queue does not bank credit.
+      queue->deficit = 0;
+    }
+    tx.pacer.on_sent(now_ms);
+    return true;
   }
 
-  std::optional<std::vector<std::byte>> TxHandler::try_build_probe_lane(
-      std::uint32_t conn_id,
-      const RxSessionState &rx,
-      TxSessionState &tx)
+  std::size_t TxHandler::gather_fragment(ChannelQueue &queue,
+                                         std::uint32_t seq,
+                                         const TxSessionState &tx)
   {
-    if (tx.probe.pong_pending) {
-      auto header = make_internal_probe_header(
-          conn_id, static_cast<Rudp::Flags>(Rudp::Flag::Pong), rx);
-      tx.probe.pong_pending = false;
-      return Rudp::Codec::encode(header, {});
+    const SendRequest &request = queue.pending.front();
+    const auto slice = tx.fragment_slice_size;
+    if (slice == 0 || !Rudp::isReliableChannel(request.channel_type) ||
+        request.payload.size() <= slice + Rudp::kFragmentHeaderSize)
+    {
+      return 0;
+    }
+    const auto count = (request.payload.size() + slice - 1U) / slice;
+    if (count > Rudp::kMaxFragmentCount ||
+        request.payload.size() > std::numeric_limits<std::uint32_t>::max())
+    {
+      return 0;
     }
 
-    if (!tx.probe.ping_pending) {
-      return std::nullopt;
+    // Every fragment but the last carries exactly `slice` bytes, which is how
+    // the receiver places them without a per-fragment offset.
+    const auto offset = queue.front_fragment_offset;
+    if (offset == 0) {
+      queue.front_fragment_first_seq = seq;
     }
+    const auto size = std::min(slice, request.payload.size() - offset);
+    payload_scratch_.resize(Rudp::kFragmentHeaderSize + size);
+    Rudp::Codec::write_fragment_header(
+        payload_scratch_,
+        Rudp::FragmentHeader{
+            .message_size = static_cast<std::uint32_t>(request.payload.size()),
+            .index = static_cast<std::uint16_t>(offset / slice),
+            .count = static_cast<std::uint16_t>(count),
+            .first_seq = queue.front_fragment_first_seq,
+        });
+    std::copy_n(request.payload.begin() + static_cast<std::ptrdiff_t>(offset),
+                size,
+                payload_scratch_.begin() +
+                    static_cast<std::ptrdiff_t>(Rudp::kFragmentHeaderSize));
+    return size;
+  }
 
-    auto header = make_internal_probe_header(
-        conn_id, static_cast<Rudp::Flags>(Rudp::Flag::Ping), rx);
-    tx.probe.ping_pending = false;
-    return Rudp::Codec::encode(header, {});
+  std::size_t TxHandler::gather_bundle(const Rudp::HeaderExtensions &extensions,
+                                       const ChannelQueue &queue,
+                                       const TxSessionState &tx)
+  {
+    payload_scratch_.clear();
+    const SendRequest &first = queue.pending.front();
+    if (tx.bundle_max_datagram_bytes == 0 ||
+        first.channel_type == Rudp::ChannelType::MonotonicState)
+    {
+      return 0;
+    }
+
+    // Queues are per channel, so the bundle keeps the channel's order.
+    std::size_t count = 0;
+    for (const SendRequest &request : queue.pending)
+    {
+      if (request.channel_type != first.channel_type ||
+          request.payload.size() > Rudp::kMaxBundledMessageSize)
+      {
+        break;
+      }
+      const auto bundle_size = payload_scratch_.size() +
+                               Rudp::kBundleRecordHeaderSize +
+                               request.payload.size();
+      if (Rudp::Codec::encoded_size(extensions, bundle_size) >
+          tx.bundle_max_datagram_bytes)
+      {
+        break;
+      }
+      Rudp::Codec::append_bundled_message(payload_scratch_, request.payload);
+      ++count;
+    }
+    return count;
   }
 
-  OwnedPacket TxHandler::make_packet_from_request(const SendRequest &req,
-                                                  std::uint32_t conn_id,
-                                                  const RxSessionState &rx,
-                                                  TxSessionState &tx,
-                                                  bool assign_reliable_seq)
+  bool TxHandler::try_build_probe_lane(DatagramOutput &output,
+                                       std::uint32_t conn_id,
+                                       const RxSessionState &rx,
+                                       TxSessionState &tx)
   {
-    OwnedPacket packet;
-    packet.header.conn_id = conn_id;
-    packet.header.channel_id = req.channel_id;
-    packet.header.channel_type = req.channel_type;
-    packet.header.ack = rx.next_expected;
-    packet.header.ack_bits = rx.received_bits;
-    // Ack/AckBits from RX state are copied into every outbound header here.
+    Rudp::Flags flags = 0;
+    if (tx.probe.pong_pending) {
+      flags = static_cast<Rudp::Flags>(Rudp::Flag::Pong);
+    } else if (tx.probe.ping_pending) {
+      flags = static_cast<Rudp::Flags>(Rudp::Flag::Ping);
+    } else {
+      return false;
+    }
 
-    if (assign_reliable_seq) {
-      // Reliable sequence numbers are assigned only when a packet is selected for
-      // outbound transmission, not during queue_send().
-      packet.header.seq = tx.next_seq++;
+    const auto header = make_internal_probe_header(conn_id, flags, rx);
+    const auto extensions = make_extensions(header, rx, tx);
+    if (!output.fits(Rudp::Codec::encoded_size(extensions, 0U))) {
+      return false;
+    }
+    if (tx.probe.pong_pending) {
+      tx.probe.pong_pending = false;
     } else {
-      packet.header.seq = 0;
+      tx.probe.ping_pending = false;
     }
+    output.encode(header, extensions, {});
+    return true;
+  }
 
-    packet.payload = req.payload;
-    return packet;
+  Header TxHandler::make_header_from_request(const SendRequest &req,
+                                             std::uint32_t conn_id,
+                                             const RxSessionState &rx,
+                                             const TxSessionState &tx,
+                                             bool assign_reliable_seq) const
+  {
+    Header header{};
+    header.conn_id = conn_id;
+    header.channel_id = req.channel_id;
+    header.channel_type = req.channel_type;
+    header.ack = rx.next_expected;
+    header.ack_bits = rx.received_bits;
+    // Ack/AckBits from RX state are copied into every outbound header here.
+
+    // Reliable sequence numbers are assigned only when a packet is selected
+    // for outbound transmission, not during queue_send(). The caller advances
+    // next_seq once the packet is known to fit.
+    header.seq = assign_reliable_seq ? tx.next_seq : 0;
+    return header;
   }
 
-  std::optional<std::vector<std::byte>> TxHandler::build_control_packet(
-      std::uint64_t now_ms,
-      std::uint32_t conn_id,
-      Rudp::Flags flags,
-      const RxSessionState &rx,
-      TxSessionState &tx)
+  bool TxHandler::build_control_packet(DatagramOutput &output,
+                                       std::uint64_t now_ms,
+                                       std::uint32_t conn_id,
+                                       Rudp::Flags flags,
+                                       const RxSessionState &rx,
+                                       TxSessionState &tx)
   {
     const bool assign_reliable_seq = consumes_reliable_seq(flags);
     if (assign_reliable_seq && reliable_window_full(tx)) {
-      return std::nullopt;
+      return false;
     }
 
     Header header{};
@@ -412,16 +967,20 @@ TxPollResult TxHandler::poll(std::uint64_t now_ms,
     header.flags = flags;
     header.ack = rx.next_expected;
     header.ack_bits = rx.received_bits;
-
     if (assign_reliable_seq) {
-      header.seq = tx.next_seq++;
+      header.seq = tx.next_seq;
     }
 
-    auto encoded = Rudp::Codec::encode(header, {});
+    const auto extensions = make_extensions(header, rx, tx);
+    if (!output.fits(Rudp::Codec::encoded_size(extensions, 0U))) {
+      return false;
+    }
+    output.encode(header, extensions, {});
     if (!assign_reliable_seq) {
-      return encoded;
+      return true;
     }
 
+    ++tx.next_seq;
     TxEntry entry{
         .packet = OwnedPacket{.header = header, .payload = {}},
         .first_send_ms = now_ms,
@@ -429,9 +988,11 @@ TxPollResult TxHandler::poll(std::uint64_t now_ms,
         .retry_count = 0,
         .gap_evidence_count = 0,
         .fast_retx_pending = false,
+        .delivery = tx.congestion.delivery_stamp(now_ms),
+        .stream_seq = std::nullopt,
     };
     tx.inflight.emplace(header.seq, std::move(entry));
-    return encoded;
+    return true;
   }
 
 }  // namespace Rudp::Session
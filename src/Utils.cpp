@@ -4,6 +4,16 @@
 
 namespace Rudp::Utils {
 
+std::uint16_t readU16(std::span<const std::byte> bytes,
+                      std::size_t offset) noexcept {
+  return static_cast<std::uint16_t>(
+      (static_cast<std::uint16_t>(
+           std::to_integer<std::uint8_t>(bytes[offset + 0]))
+       << 8) |
+      static_cast<std::uint16_t>(
+          std::to_integer<std::uint8_t>(bytes[offset + 1])));
+}
+
 std::uint32_t readU32(std::span<const std::byte> bytes,
                       std::size_t offset) noexcept {
   return (static_cast<std::uint32_t>(
@@ -31,6 +41,12 @@ std::uint64_t readU64(std::span<const std::byte> bytes,
   return value;
 }
 
+void writeU16(std::span<std::byte> bytes, std::size_t offset,
+              std::uint16_t value) noexcept {
+  bytes[offset + 0] = static_cast<std::byte>((value >> 8) & 0xff);
+  bytes[offset + 1] = static_cast<std::byte>(value & 0xff);
+}
+
 void writeU32(std::span<std::byte> bytes, std::size_t offset,
               std::uint32_t value) noexcept {
   bytes[offset + 0] = static_cast<std::byte>((value >> 24) & 0xff);
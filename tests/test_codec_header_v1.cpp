@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <span>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -74,10 +77,11 @@ TEST(CodecHeaderTest, HeaderValidationRejectsReservedByte) {
   EXPECT_FALSE(Rudp::Codec::isValidHeader(header));
 }
 
-// Verifies header validation rejects use of reserved flag bits.
-TEST(CodecHeaderTest, HeaderValidationRejectsReservedFlagBits) {
+// Verifies header validation rejects a packet flagged as both a bundle and a
+// fragment.
+TEST(CodecHeaderTest, HeaderValidationRejectsBundledFragment) {
   Rudp::Header header;
-  header.flags = 0x80;
+  header.flags = Rudp::Flag::Bundle | Rudp::Flag::Fragment;
 
   EXPECT_FALSE(Rudp::Codec::isValidHeader(header));
 }
@@ -93,6 +97,201 @@ TEST(CodecHeaderTest, DecodeRejectsInvalidChannelType) {
   EXPECT_FALSE(decoded.has_value());
 }
 
+// Verifies Window and SACK TLVs survive a round-trip, extend HeaderLen and
+// leave the payload boundary intact.
+TEST(CodecHeaderTest, EncodeDecodeRoundTripPreservesExtensions) {
+  Rudp::Header header;
+  header.seq = 7u;
+  header.flags = Rudp::Flag::Syn | Rudp::Flag::Ack;
+
+  Rudp::HeaderExtensions extensions;
+  extensions.window = 1024u;
+  extensions.sack_ranges[0] = Rudp::SackRange{.begin = 100u, .end = 120u};
+  extensions.sack_ranges[1] = Rudp::SackRange{.begin = 0xfffffff0u, .end = 4u};
+  extensions.sack_range_count = 2;
+  extensions.cookie.emplace();
+  for (std::size_t i = 0; i < Rudp::kHandshakeCookieSize; ++i) {
+    (*extensions.cookie)[i] = static_cast<std::byte>(0xc0U + i);
+  }
+
+  const std::array payload = {std::byte{0x42}};
+  const auto bytes = Rudp::Codec::encode(header, extensions, payload);
+
+  const auto decoded = Rudp::Codec::decode(bytes);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->header.header_len,
+            Rudp::kHeaderLength + Rudp::Codec::encoded_extensions_size(extensions));
+  ASSERT_EQ(decoded->payload.size(), 1U);
+  EXPECT_EQ(decoded->payload[0], payload[0]);
+
+  const auto parsed = Rudp::Codec::decode_extensions(decoded->extensions);
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->window, std::optional<std::uint32_t>(1024u));
+  ASSERT_EQ(parsed->sacks().size(), 2U);
+  EXPECT_EQ(parsed->sacks()[0].begin, 100u);
+  EXPECT_EQ(parsed->sacks()[0].end, 120u);
+  EXPECT_EQ(parsed->sacks()[1].begin, 0xfffffff0u);
+  EXPECT_EQ(parsed->sacks()[1].end, 4u);
+  EXPECT_EQ(parsed->cookie, extensions.cookie);
+}
+
+// Verifies unknown TLVs are skipped while a TLV overrunning HeaderLen makes
+// the whole packet invalid.
+TEST(CodecHeaderTest, DecodeSkipsUnknownExtensionsAndRejectsTruncatedOnes) {
+  auto bytes = Rudp::Codec::encode(Rudp::Header{}, {});
+  const std::array unknown_tlv = {std::byte{0x7e}, std::byte{0x02},
+                                  std::byte{0xaa}, std::byte{0xbb}};
+  bytes.insert(bytes.end(), unknown_tlv.begin(), unknown_tlv.end());
+  bytes[26] = std::byte{Rudp::kHeaderLength + 4};
+
+  const auto decoded = Rudp::Codec::decode(bytes);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_TRUE(decoded->payload.empty());
+  const auto parsed = Rudp::Codec::decode_extensions(decoded->extensions);
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_TRUE(parsed->empty());
+
+  bytes[Rudp::kHeaderLength + 1] = std::byte{0x03};
+  EXPECT_FALSE(Rudp::Codec::decode(bytes).has_value());
+}
+
+// Verifies encode_into refuses a buffer one byte too small without writing to
+// it and otherwise produces the same bytes as encode().
+TEST(CodecHeaderTest, EncodeIntoMatchesEncodeAndRejectsShortBuffer) {
+  Rudp::Header header;
+  header.seq = 11u;
+  header.channel_type = Rudp::ChannelType::ReliableUnordered;
+  Rudp::HeaderExtensions extensions;
+  extensions.window = 256u;
+  const std::array payload = {std::byte{0x01}, std::byte{0x02}};
+
+  const auto expected = Rudp::Codec::encode(header, extensions, payload);
+  ASSERT_EQ(expected.size(),
+            Rudp::Codec::encoded_size(extensions, payload.size()));
+
+  std::array<std::byte, 64> buffer{};
+  const auto too_small =
+      std::span<std::byte>(buffer.data(), expected.size() - 1U);
+  EXPECT_FALSE(Rudp::Codec::encode_into(too_small, header, extensions, payload)
+                   .has_value());
+  EXPECT_EQ(buffer[0], std::byte{0x00});
+
+  const auto written =
+      Rudp::Codec::encode_into(buffer, header, extensions, payload);
+  ASSERT_EQ(written, std::optional<std::size_t>(expected.size()));
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buffer.begin()));
+}
+
+// Verifies patch_ack rewrites the ACK fields of an encoded datagram while
+// keeping its payload, and refuses extensions of a different encoded size.
+TEST(CodecHeaderTest, PatchAckRewritesAckFieldsInPlace) {
+  Rudp::Header header;
+  header.seq = 5u;
+  header.ack = 1u;
+  header.flags = static_cast<Rudp::Flags>(Rudp::Flag::Ack);
+  header.channel_type = Rudp::ChannelType::ReliableOrdered;
+  Rudp::HeaderExtensions extensions;
+  extensions.sack_ranges[0] = Rudp::SackRange{.begin = 3u, .end = 4u};
+  extensions.sack_range_count = 1;
+  const std::array payload = {std::byte{0x7a}};
+  auto bytes = Rudp::Codec::encode(header, extensions, payload);
+
+  extensions.sack_ranges[0] = Rudp::SackRange{.begin = 9u, .end = 12u};
+  ASSERT_TRUE(Rudp::Codec::patch_ack(bytes, 8u, 0x3ULL, extensions));
+
+  const auto decoded = Rudp::Codec::decode(bytes);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->header.seq, 5u);
+  EXPECT_EQ(decoded->header.ack, 8u);
+  EXPECT_EQ(decoded->header.ack_bits, 0x3ULL);
+  ASSERT_EQ(decoded->payload.size(), 1U);
+  EXPECT_EQ(decoded->payload[0], payload[0]);
+  const auto parsed = Rudp::Codec::decode_extensions(decoded->extensions);
+  ASSERT_TRUE(parsed.has_value());
+  ASSERT_EQ(parsed->sacks().size(), 1U);
+  EXPECT_EQ(parsed->sacks()[0].begin, 9u);
+
+  const auto before = bytes;
+  extensions.sack_range_count = 0;
+  EXPECT_FALSE(Rudp::Codec::patch_ack(bytes, 20u, 0u, extensions));
+  EXPECT_EQ(bytes, before);
+}
+
+// Verifies BUNDLE payloads split back into their messages, the FEATURES TLV
+// round-trips, and a bundle with a truncated record is rejected.
+TEST(CodecHeaderTest, BundleRecordsAndFeaturesRoundTrip) {
+  Rudp::Header header;
+  header.flags = static_cast<Rudp::Flags>(Rudp::Flag::Bundle);
+  Rudp::HeaderExtensions extensions;
+  extensions.features = Rudp::kFeatureBundle;
+
+  const std::array first = {std::byte{0x01}, std::byte{0x02}};
+  const std::array second = {std::byte{0x03}};
+  std::vector<std::byte> bundle;
+  Rudp::Codec::append_bundled_message(bundle, first);
+  Rudp::Codec::append_bundled_message(bundle, {});
+  Rudp::Codec::append_bundled_message(bundle, second);
+  auto bytes = Rudp::Codec::encode(header, extensions, bundle);
+
+  const auto decoded = Rudp::Codec::decode(bytes);
+  ASSERT_TRUE(decoded.has_value());
+  const auto parsed = Rudp::Codec::decode_extensions(decoded->extensions);
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->features,
+            std::optional<std::uint32_t>(Rudp::kFeatureBundle));
+
+  std::vector<std::size_t> sizes;
+  std::size_t offset = 0;
+  while (const auto message =
+             Rudp::Codec::next_bundled_message(decoded->payload, offset)) {
+    sizes.push_back(message->size());
+  }
+  EXPECT_EQ(sizes, (std::vector<std::size_t>{2U, 0U, 1U}));
+
+  bytes.pop_back();
+  EXPECT_FALSE(Rudp::Codec::decode(bytes).has_value());
+}
+
+// Verifies the FRAGMENT prefix round-trips and that decode rejects fragments
+// on unreliable channels or with an index outside their count.
+TEST(CodecHeaderTest, FragmentHeaderRoundTripsAndIsValidated) {
+  Rudp::Header header;
+  header.flags = static_cast<Rudp::Flags>(Rudp::Flag::Fragment);
+  header.channel_type = Rudp::ChannelType::ReliableUnordered;
+
+  std::vector<std::byte> payload(Rudp::kFragmentHeaderSize + 3U);
+  Rudp::Codec::write_fragment_header(
+      payload,
+      Rudp::FragmentHeader{.message_size = 4000u,
+                           .index = 2u,
+                           .count = 4u,
+                           .first_seq = 0xfffffffeu});
+  const auto bytes = Rudp::Codec::encode(header, payload);
+
+  const auto decoded = Rudp::Codec::decode(bytes);
+  ASSERT_TRUE(decoded.has_value());
+  const auto fragment = Rudp::Codec::read_fragment_header(decoded->payload);
+  ASSERT_TRUE(fragment.has_value());
+  EXPECT_EQ(fragment->message_size, 4000u);
+  EXPECT_EQ(fragment->index, 2u);
+  EXPECT_EQ(fragment->count, 4u);
+  EXPECT_EQ(fragment->first_seq, 0xfffffffeu);
+
+  header.channel_type = Rudp::ChannelType::Unreliable;
+  EXPECT_FALSE(
+      Rudp::Codec::decode(Rudp::Codec::encode(header, payload)).has_value());
+
+  header.channel_type = Rudp::ChannelType::ReliableUnordered;
+  Rudp::Codec::write_fragment_header(
+      payload,
+      Rudp::FragmentHeader{.message_size = 4000u,
+                           .index = 4u,
+                           .count = 4u,
+                           .first_seq = 0u});
+  EXPECT_FALSE(
+      Rudp::Codec::decode(Rudp::Codec::encode(header, payload)).has_value());
+}
+
 // Verifies Header::hasFlag reports set and unset bits correctly.
 TEST(ProtocolHeaderTest, HasFlagChecksBitPresence) {
   Rudp::Header header;
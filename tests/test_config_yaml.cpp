@@ -15,6 +15,8 @@ TEST(ConfigYamlTest, LoadsClientProfileWithChannels) {
   output << "mode: client\n"
             "runtime:\n"
             "  log_path: logs/test_client.log\n"
+            "transport:\n"
+            "  congestion_control: cubic\n"
             "connection:\n"
             "  bind_address: 0.0.0.0\n"
             "  bind_port: 0\n"
@@ -27,7 +29,9 @@ TEST(ConfigYamlTest, LoadsClientProfileWithChannels) {
             "    default: true\n"
             "  - id: 8\n"
             "    name: state\n"
-            "    type: unreliable\n";
+            "    type: unreliable\n"
+            "    priority: 1\n"
+            "    weight: 4\n";
   output.close();
 
   Rudp::Config::RuntimeProfile profile;
@@ -39,11 +43,17 @@ TEST(ConfigYamlTest, LoadsClientProfileWithChannels) {
   EXPECT_EQ(profile.mode, Rudp::Config::RuntimeMode::Client);
   EXPECT_EQ(profile.remote_address, "127.0.0.1");
   EXPECT_EQ(profile.remote_port, 9010);
+  EXPECT_EQ(profile.congestion_control,
+            Rudp::Config::CongestionControl::Cubic);
   ASSERT_EQ(profile.channels.size(), 2U);
   EXPECT_EQ(profile.channels[0].id, 7U);
   EXPECT_EQ(profile.channels[0].name, "chat");
   EXPECT_EQ(profile.channels[0].type, Rudp::ChannelType::ReliableOrdered);
   EXPECT_TRUE(profile.channels[0].is_default);
+  EXPECT_EQ(profile.channels[0].priority, 0U);
+  EXPECT_EQ(profile.channels[0].weight, 1U);
+  EXPECT_EQ(profile.channels[1].priority, 1U);
+  EXPECT_EQ(profile.channels[1].weight, 4U);
 }
 
 TEST(ConfigYamlTest, DefaultsChannelWhenProfileOmitsChannels) {
@@ -0,0 +1,155 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Rudp/CongestionControl.hpp"
+#include "Rudp/SessionTypes.hpp"
+#include "Rudp/TxHandler.hpp"
+
+namespace {
+
+using Rudp::Config::CongestionControl;
+using Rudp::Session::CongestionController;
+using Rudp::Session::ConnectionState;
+using Rudp::Session::DeliveryStamp;
+using Rudp::Session::RxSessionState;
+using Rudp::Session::SessionRole;
+using Rudp::Session::TxHandler;
+using Rudp::Session::TxSessionState;
+
+void ack_packets(CongestionController& controller,
+                 std::uint32_t count,
+                 std::uint32_t cumulative_ack,
+                 std::uint64_t now_ms) {
+  for (std::uint32_t i = 0; i < count; ++i) {
+    controller.on_packet_acked(DeliveryStamp{}, now_ms);
+  }
+  controller.on_ack_processed(cumulative_ack, std::nullopt, 10'000U, now_ms);
+}
+
+// Verifies NewReno doubles per window in slow start, halves once per
+// congestion event however many losses it contains, and resumes additive
+// increase only after the recovery point is acknowledged.
+TEST(CongestionControlTest, NewRenoHalvesOncePerLossWindow) {
+  CongestionController controller(CongestionControl::NewReno);
+  ASSERT_EQ(controller.window_packets(), 10U);
+
+  ack_packets(controller, 10U, 10U, 10U);
+  EXPECT_EQ(controller.window_packets(), 20U);
+
+  controller.on_fast_loss(12U, 30U, 20U);
+  EXPECT_EQ(controller.window_packets(), 10U);
+  controller.on_fast_loss(15U, 30U, 21U);
+  EXPECT_EQ(controller.window_packets(), 10U);
+
+  ack_packets(controller, 5U, 20U, 30U);
+  EXPECT_EQ(controller.window_packets(), 10U);
+
+  ack_packets(controller, 10U, 30U, 40U);
+  EXPECT_FALSE(controller.in_slow_start());
+  EXPECT_EQ(controller.window_packets(), 11U);
+
+  controller.on_fast_loss(31U, 45U, 50U);
+  EXPECT_EQ(controller.window_packets(), 5U);
+}
+
+// Verifies CUBIC drops to beta * W_max on loss, then grows back through the
+// concave region to W_max and on into the convex probing region.
+TEST(CongestionControlTest, CubicRecoversTowardPreviousMaximum) {
+  CongestionController controller(CongestionControl::Cubic);
+  ack_packets(controller, 10U, 10U, 10U);
+  ASSERT_EQ(controller.window_packets(), 20U);
+
+  controller.on_fast_loss(11U, 20U, 100U);
+  EXPECT_EQ(controller.window_packets(), 14U);
+
+  std::uint32_t ack = 20U;
+  std::uint32_t previous = controller.window_packets();
+  bool reached_previous_maximum = false;
+  for (std::uint64_t now = 200U; now <= 6'000U; now += 10U) {
+    ack += 1U;
+    ack_packets(controller, 1U, ack, now);
+    EXPECT_GE(controller.window_packets(), previous);
+    previous = controller.window_packets();
+    if (now <= 1'500U) {
+      EXPECT_LT(previous, 20U) << "at " << now << " ms";
+    }
+    reached_previous_maximum = reached_previous_maximum || previous >= 20U;
+  }
+  EXPECT_TRUE(reached_previous_maximum);
+  EXPECT_GT(previous, 20U);
+}
+
+// Verifies BbrLite leaves startup once delivery rate stops growing and then
+// sizes the window to twice the measured bandwidth-delay product.
+TEST(CongestionControlTest, BbrLiteSizesWindowFromBandwidthDelayProduct) {
+  CongestionController controller(CongestionControl::BbrLite);
+  constexpr std::uint32_t kPacketsPerRound = 20;
+  constexpr std::uint64_t kRttMs = 10;
+
+  std::uint32_t ack = 0;
+  for (std::uint64_t round = 0; round < 8U; ++round) {
+    const auto sent_ms = round * kRttMs;
+    std::vector<DeliveryStamp> stamps(kPacketsPerRound,
+                                      controller.delivery_stamp(sent_ms));
+    for (const auto& stamp : stamps) {
+      controller.on_packet_acked(stamp, sent_ms + kRttMs);
+    }
+    ack += kPacketsPerRound;
+    controller.on_ack_processed(ack, kRttMs, kRttMs * 1000U, sent_ms + kRttMs);
+  }
+
+  ASSERT_TRUE(controller.bottleneck_rate().has_value());
+  EXPECT_DOUBLE_EQ(*controller.bottleneck_rate(), 2'000.0);
+  EXPECT_EQ(controller.window_packets(), 40U);
+
+  // Isolated losses do not shrink the model-based window.
+  controller.on_fast_loss(ack, ack + 40U, 100U);
+  EXPECT_EQ(controller.window_packets(), 40U);
+}
+
+// Verifies the TX path holds fresh reliable data at the congestion window,
+// opens it as ACKs arrive, and collapses it on a retransmission timeout while
+// still retransmitting everything that timed out.
+TEST(CongestionControlTest, TxHandlerLimitsFreshReliableDataToWindow) {
+  TxHandler handler;
+  TxSessionState tx;
+  RxSessionState rx;
+  tx.congestion = CongestionController(CongestionControl::NewReno);
+  auto connection_state = ConnectionState::Established;
+  const std::vector<std::byte> payload{std::byte{0x2a}};
+  for (int i = 0; i < 30; ++i) {
+    handler.queue_app_data(1U, Rudp::ChannelType::ReliableUnordered, payload,
+                           tx);
+  }
+
+  const auto drain = [&](std::uint64_t now_ms) {
+    std::size_t fresh = 0;
+    std::size_t retransmitted = 0;
+    while (true) {
+      auto result = handler.poll(now_ms, SessionRole::Client, 7U,
+                                 connection_state, rx, tx);
+      if (!result.datagram.has_value()) {
+        return std::pair{fresh, retransmitted};
+      }
+      ++(result.retransmission ? retransmitted : fresh);
+    }
+  };
+
+  EXPECT_EQ(drain(0U), (std::pair<std::size_t, std::size_t>{10U, 0U}));
+  EXPECT_EQ(tx.inflight.size(), 10U);
+
+  static_cast<void>(handler.on_remote_ack(5U, 0U, 5U, tx));
+  EXPECT_EQ(tx.congestion.window_packets(), 15U);
+  EXPECT_EQ(drain(5U), (std::pair<std::size_t, std::size_t>{10U, 0U}));
+
+  EXPECT_EQ(drain(1'000U), (std::pair<std::size_t, std::size_t>{0U, 15U}));
+  EXPECT_EQ(tx.congestion.window_packets(), 1U);
+  EXPECT_EQ(tx.pending_send_count, 10U);
+}
+
+}  // namespace
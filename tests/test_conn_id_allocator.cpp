@@ -0,0 +1,57 @@
+#include <cstdint>
+#include <unordered_set>
+
+#include <gtest/gtest.h>
+
+#include "Rudp/ConnIdAllocator.hpp"
+
+namespace {
+
+using Rudp::Session::ConnIdAllocator;
+
+// Verifies every id carries its shard's residue, is never 0, and does not
+// repeat within a generation.
+TEST(ConnIdAllocatorTest, IdsIdentifyTheirShardAndDoNotRepeat) {
+  constexpr std::uint32_t kShards = 4U;
+  for (std::uint32_t shard = 0; shard < kShards; ++shard) {
+    ConnIdAllocator allocator(shard, kShards, 0x1234'5678'9abc'def0ULL);
+    std::unordered_set<std::uint32_t> seen;
+    for (int i = 0; i < 10000; ++i) {
+      const auto id = allocator.next();
+      ASSERT_NE(id, 0U);
+      ASSERT_EQ(ConnIdAllocator::shard_of(id, kShards), shard);
+      ASSERT_TRUE(seen.insert(id).second);
+    }
+  }
+}
+
+// Verifies a tiny id space is walked completely before any id recurs, which
+// is what makes a wrap the only source of collisions.
+TEST(ConnIdAllocatorTest, CoversTheWholeSpaceBeforeTheNextGeneration) {
+  // With 2^31 shards, shard 1 owns only ids 1 and 2^31 + 1.
+  constexpr std::uint32_t kShards = 0x8000'0000U;
+  ConnIdAllocator allocator(1U, kShards, 42U);
+  std::unordered_set<std::uint32_t> seen;
+  seen.insert(allocator.next());
+  seen.insert(allocator.next());
+  EXPECT_EQ(seen, (std::unordered_set<std::uint32_t>{1U, 0x8000'0001U}));
+  EXPECT_TRUE(seen.contains(allocator.next()));
+  EXPECT_GE(allocator.generation(), 1U);
+}
+
+// Verifies a fixed key gives a reproducible sequence and different keys
+// give different ones.
+TEST(ConnIdAllocatorTest, SequenceDependsOnlyOnTheKey) {
+  ConnIdAllocator first(0U, 1U, 7U);
+  ConnIdAllocator second(0U, 1U, 7U);
+  ConnIdAllocator other(0U, 1U, 8U);
+  bool differs = false;
+  for (int i = 0; i < 16; ++i) {
+    const auto id = first.next();
+    EXPECT_EQ(id, second.next());
+    differs = differs || id != other.next();
+  }
+  EXPECT_TRUE(differs);
+}
+
+}  // namespace
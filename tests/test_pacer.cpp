@@ -0,0 +1,96 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Rudp/Config.hpp"
+#include "Rudp/Pacer.hpp"
+#include "Rudp/SessionTypes.hpp"
+#include "Rudp/TxHandler.hpp"
+
+namespace {
+
+using Rudp::Session::ConnectionState;
+using Rudp::Session::Pacer;
+using Rudp::Session::RxSessionState;
+using Rudp::Session::SessionRole;
+using Rudp::Session::TxHandler;
+using Rudp::Session::TxSessionState;
+
+// Verifies the bucket allows one burst, then one packet per refill interval,
+// and never banks more than the burst while idle.
+TEST(PacerTest, TokenBucketSpacesSendsAfterBurst) {
+  Pacer pacer(2U);
+  EXPECT_TRUE(pacer.can_send(0U));
+  EXPECT_EQ(pacer.rate(), std::nullopt);
+
+  pacer.set_rate(500.0, 100U);
+  pacer.on_sent(100U);
+  pacer.on_sent(100U);
+  EXPECT_FALSE(pacer.can_send(100U));
+  EXPECT_EQ(pacer.next_send_ms(100U), 102U);
+  EXPECT_FALSE(pacer.can_send(101U));
+  EXPECT_TRUE(pacer.can_send(102U));
+
+  pacer.on_sent(102U);
+  EXPECT_EQ(pacer.next_send_ms(102U), 104U);
+
+  // A long idle gap refills only up to the burst.
+  EXPECT_TRUE(pacer.can_send(10'000U));
+  pacer.on_sent(10'000U);
+  pacer.on_sent(10'000U);
+  EXPECT_FALSE(pacer.can_send(10'000U));
+
+  pacer.set_rate(std::nullopt, 10'000U);
+  EXPECT_TRUE(pacer.can_send(10'000U));
+  EXPECT_EQ(pacer.next_send_ms(10'000U), 10'000U);
+}
+
+// Verifies a session with a fixed pacing rate releases queued data at that
+// rate, reports the next token as its deadline, and leaves ACK-only packets
+// unpaced.
+TEST(PacerTest, TxHandlerPacesFreshDataAtConfiguredRate) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous = settings.transport;
+  settings.transport.enable_pacing = true;
+  settings.transport.pacing_rate_pps = 1'000U;
+
+  TxHandler handler;
+  TxSessionState tx;
+  RxSessionState rx;
+  tx.pacer = Pacer(2U);
+  auto connection_state = ConnectionState::Established;
+  const std::vector<std::byte> payload{std::byte{0x11}};
+  for (int i = 0; i < 6; ++i) {
+    handler.queue_app_data(1U, Rudp::ChannelType::Unreliable, payload, tx);
+  }
+
+  const auto poll = [&](std::uint64_t now_ms) {
+    return handler.poll(now_ms, SessionRole::Client, 3U, connection_state, rx,
+                        tx).datagram.has_value();
+  };
+
+  EXPECT_TRUE(poll(50U));
+  EXPECT_TRUE(poll(50U));
+  EXPECT_FALSE(poll(50U));
+  EXPECT_EQ(handler.next_deadline_ms(50U, SessionRole::Client, connection_state,
+                                     tx),
+            std::optional<std::uint64_t>(51U));
+
+  tx.ack_only_pending = true;
+  EXPECT_TRUE(poll(50U));
+  EXPECT_FALSE(tx.ack_only_pending);
+
+  EXPECT_TRUE(poll(51U));
+  EXPECT_FALSE(poll(51U));
+  EXPECT_TRUE(poll(52U));
+  EXPECT_TRUE(poll(53U));
+  EXPECT_TRUE(poll(54U));
+  EXPECT_EQ(tx.pending_send_count, 0U);
+
+  settings.transport = previous;
+}
+
+}  // namespace
@@ -0,0 +1,87 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Rudp/RxHandler.hpp"
+
+namespace {
+
+using Rudp::Session::ControlKind;
+using Rudp::Session::RxHandler;
+using Rudp::Session::RxSessionState;
+using Rudp::Session::SessionEvent;
+
+void receive(RxHandler& handler,
+             RxSessionState& rx,
+             std::uint32_t seq,
+             std::uint32_t channel_id,
+             Rudp::ChannelType channel_type,
+             std::optional<std::uint32_t> stream_seq = std::nullopt) {
+  Rudp::Header header;
+  header.seq = seq;
+  header.channel_id = channel_id;
+  header.channel_type = channel_type;
+  const std::array payload = {static_cast<std::byte>(seq & 0xffU)};
+  Rudp::HeaderExtensions extensions;
+  extensions.stream_seq = stream_seq;
+  static_cast<void>(handler.on_packet(
+      Rudp::PacketView{.header = header, .payload = payload}, extensions, 100U,
+      ControlKind::None, rx));
+}
+
+[[nodiscard]] std::vector<std::uint32_t> delivered_seqs(
+    const std::vector<SessionEvent>& events) {
+  std::vector<std::uint32_t> seqs;
+  for (const auto& event : events) {
+    seqs.push_back(event.seq);
+  }
+  return seqs;
+}
+
+// Verifies session-wide ordered delivery steps over a seq that turned out to
+// belong to another channel instead of waiting for it forever.
+TEST(RxHandlerOrderingTest, SessionOrderSkipsSeqsOfOtherChannels) {
+  RxHandler handler;
+  RxSessionState rx;
+  rx.next_expected = 10U;
+
+  receive(handler, rx, 10U, 1U, Rudp::ChannelType::ReliableOrdered);
+  receive(handler, rx, 12U, 1U, Rudp::ChannelType::ReliableOrdered);
+  EXPECT_EQ(delivered_seqs(handler.drain_events(rx)),
+            (std::vector<std::uint32_t>{10U}));
+
+  receive(handler, rx, 11U, 2U, Rudp::ChannelType::ReliableUnordered);
+  EXPECT_EQ(delivered_seqs(handler.drain_events(rx)),
+            (std::vector<std::uint32_t>{11U, 12U}));
+  EXPECT_TRUE(rx.ordered_reorder_buffer.empty());
+}
+
+// Verifies a gap on one ordered stream does not hold back another stream, and
+// that the stalled stream drains in stream order once the gap fills.
+TEST(RxHandlerOrderingTest, LossOnOneStreamDoesNotBlockAnother) {
+  RxHandler handler;
+  RxSessionState rx;
+  rx.next_expected = 100U;
+
+  // Seq 100 (stream 1, stream seq 0) is lost for now.
+  receive(handler, rx, 101U, 1U, Rudp::ChannelType::ReliableOrdered, 1U);
+  receive(handler, rx, 102U, 2U, Rudp::ChannelType::ReliableOrdered, 0U);
+  receive(handler, rx, 103U, 2U, Rudp::ChannelType::ReliableOrdered, 1U);
+  const auto unblocked = handler.drain_events(rx);
+  EXPECT_EQ(delivered_seqs(unblocked), (std::vector<std::uint32_t>{102U, 103U}));
+  for (const auto& event : unblocked) {
+    EXPECT_EQ(event.channel_id, 2U);
+  }
+
+  receive(handler, rx, 100U, 1U, Rudp::ChannelType::ReliableOrdered, 0U);
+  EXPECT_EQ(delivered_seqs(handler.drain_events(rx)),
+            (std::vector<std::uint32_t>{100U, 101U}));
+  EXPECT_EQ(rx.next_expected, 104U);
+  EXPECT_TRUE(rx.ordered_streams[1U].reorder_buffer.empty());
+}
+
+}  // namespace
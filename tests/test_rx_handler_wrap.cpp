@@ -98,4 +98,58 @@ TEST(RxHandlerWrapTest, StaleReliablePacketAfterWrapBoundaryIsDropped) {
   EXPECT_TRUE(events.empty());
 }
 
+// Verifies filling the ACK front while a later gap remains re-bases AckBits so
+// bit 0 still names next_expected + 1.
+TEST(RxHandlerWrapTest, InOrderPacketBeforeGapShiftsAckBitsOntoNewFront) {
+  RxHandler handler;
+  RxSessionState rx;
+  rx.next_expected = 0xffffffffu;
+
+  for (const auto seq : {1u, 0xffffffffu}) {
+    Rudp::Header header;
+    header.seq = seq;
+    header.channel_id = 1U;
+    header.channel_type = Rudp::ChannelType::ReliableUnordered;
+    static_cast<void>(handler.on_packet(make_packet_view(header), 100U,
+                                        ControlKind::None, rx));
+  }
+
+  EXPECT_EQ(rx.next_expected, 0U);
+  EXPECT_EQ(rx.received_bits, 0x1ULL);
+}
+
+// Verifies reordered ReliableOrdered packets straddling the wrap boundary are
+// buffered and released in seq order with their payloads intact.
+TEST(RxHandlerWrapTest, ReorderedOrderedPacketsDrainInSeqOrderAcrossWrap) {
+  RxHandler handler;
+  RxSessionState rx;
+  rx.next_expected = 0xfffffffeu;
+
+  const std::array<std::uint32_t, 4> arrival = {0xfffffffeu, 1u, 0u,
+                                                0xffffffffu};
+  for (const auto seq : arrival) {
+    Rudp::Header header;
+    header.seq = seq;
+    header.channel_id = 3U;
+    header.channel_type = Rudp::ChannelType::ReliableOrdered;
+    const std::array payload = {static_cast<std::byte>(seq & 0xffU)};
+    static_cast<void>(handler.on_packet(make_packet_view(header, payload), 100U,
+                                        ControlKind::None, rx));
+  }
+
+  EXPECT_EQ(rx.next_expected, 2U);
+  EXPECT_TRUE(rx.ordered_reorder_buffer.empty());
+
+  const auto events = handler.drain_events(rx);
+  const std::array<std::uint32_t, 4> expected = {0xfffffffeu, 0xffffffffu, 0u,
+                                                 1u};
+  ASSERT_EQ(events.size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(events[i].seq, expected[i]);
+    ASSERT_EQ(events[i].payload.size(), 1U);
+    EXPECT_EQ(events[i].payload.front(),
+              static_cast<std::byte>(expected[i] & 0xffU));
+  }
+}
+
 }  // namespace
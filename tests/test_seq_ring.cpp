@@ -0,0 +1,64 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Rudp/SeqRing.hpp"
+
+namespace {
+
+using Rudp::Session::SeqRing;
+
+[[nodiscard]] std::vector<std::uint32_t> live_seqs(const SeqRing<int>& ring) {
+  std::vector<std::uint32_t> seqs;
+  for (const auto [seq, value] : ring) {
+    static_cast<void>(value);
+    seqs.push_back(seq);
+  }
+  return seqs;
+}
+
+// Verifies iteration visits live seqs oldest-first across the 32-bit wrap and
+// that erasing the front advances to the next occupied slot.
+TEST(SeqRingTest, IteratesInSeqOrderAcrossWrapAround) {
+  SeqRing<int> ring;
+  const std::uint32_t base = 0xFFFF'FFF0U;
+  for (std::uint32_t offset : {0U, 3U, 15U, 16U, 40U}) {
+    ASSERT_TRUE(ring.emplace(base + offset, static_cast<int>(offset)));
+  }
+
+  EXPECT_EQ(live_seqs(ring), (std::vector<std::uint32_t>{
+                                 base, base + 3U, 0xFFFF'FFFFU, 0U, 24U}));
+  EXPECT_EQ(ring.at(0U), 16);
+
+  EXPECT_TRUE(ring.erase(base));
+  EXPECT_EQ(ring.front_seq(), base + 3U);
+  EXPECT_TRUE(ring.erase(base + 3U));
+  EXPECT_TRUE(ring.erase(0xFFFF'FFFFU));
+  EXPECT_EQ(ring.front_seq(), 0U);
+  EXPECT_EQ(ring.size(), 2U);
+  EXPECT_FALSE(ring.contains(base));
+}
+
+// Verifies inserts that would stretch the live span past capacity, or reuse a
+// live seq, are rejected without disturbing existing entries.
+TEST(SeqRingTest, RejectsSeqsOutsideTheWindow) {
+  SeqRing<int> ring(64U);
+  ASSERT_EQ(ring.capacity(), 64U);
+  ASSERT_TRUE(ring.emplace(1'000U, 1));
+  EXPECT_TRUE(ring.emplace(1'063U, 2));
+  EXPECT_FALSE(ring.emplace(1'064U, 3));
+  EXPECT_FALSE(ring.emplace(999U, 4));
+  EXPECT_FALSE(ring.emplace(1'000U, 5));
+
+  EXPECT_EQ(ring.at(1'000U), 1);
+  EXPECT_FALSE(ring.contains(1'064U));
+  EXPECT_EQ(ring.find(1'001U), nullptr);
+
+  ring.clear();
+  EXPECT_TRUE(ring.empty());
+  EXPECT_TRUE(ring.emplace(5U, 6));
+  EXPECT_EQ(live_seqs(ring), std::vector<std::uint32_t>{5U});
+}
+
+}  // namespace
@@ -1,11 +1,15 @@
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 #include <gtest/gtest.h>
 
 #include "Rudp/Codec.hpp"
+#include "Rudp/Config.hpp"
 #include "Rudp/ServerSessionManager.hpp"
 
 namespace {
@@ -31,13 +35,21 @@ namespace {
   return Rudp::Codec::encode(header, {});
 }
 
+[[nodiscard]] Rudp::Session::EndpointKey make_endpoint(
+    std::string_view address,
+    std::uint16_t port) {
+  const auto endpoint = Rudp::Session::EndpointKey::parse(address, port);
+  EXPECT_TRUE(endpoint.has_value());
+  return endpoint.value_or(Rudp::Session::EndpointKey{});
+}
+
 }  // namespace
 
 namespace Rudp::Session {
 
 TEST(ServerSessionManagerTest, ZeroConnIdSynCreatesPendingServerSession) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"192.168.1.50", 40000};
+  const auto endpoint = make_endpoint("192.168.1.50", 40000);
 
   const auto syn =
       encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 77);
@@ -57,10 +69,25 @@ TEST(ServerSessionManagerTest, ZeroConnIdSynCreatesPendingServerSession) {
   EXPECT_EQ(*state, ConnectionState::HandshakeReceived);
 }
 
+TEST(ServerSessionManagerTest, ShardManagerAssignsConnIdsOfItsShard) {
+  ServerSessionManager manager(ConnIdAllocator(2U, 3U));
+  const auto syn =
+      encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 77);
+
+  for (std::uint16_t port = 40000; port < 40016; ++port) {
+    const auto endpoint = make_endpoint("192.168.1.50", port);
+    manager.on_datagram_received(endpoint, syn, 100U);
+    const auto conn_id = manager.pending_conn_id(endpoint);
+    ASSERT_TRUE(conn_id.has_value());
+    EXPECT_EQ(ConnIdAllocator::shard_of(*conn_id, 3U), 2U);
+  }
+  EXPECT_EQ(manager.pending_session_count(), 16U);
+}
+
 TEST(ServerSessionManagerTest,
      PendingSessionPromotesToActiveAfterFinalHandshakeAck) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"192.168.1.60", 40010};
+  const auto endpoint = make_endpoint("192.168.1.60", 40010);
 
   const auto syn =
       encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 77);
@@ -83,7 +110,7 @@ TEST(ServerSessionManagerTest,
 
 TEST(ServerSessionManagerTest, DuplicateSynReusesExistingPendingSession) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"192.168.1.50", 40000};
+  const auto endpoint = make_endpoint("192.168.1.50", 40000);
 
   const auto syn =
       encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 88);
@@ -100,7 +127,7 @@ TEST(ServerSessionManagerTest, DuplicateSynReusesExistingPendingSession) {
 
 TEST(ServerSessionManagerTest, ActiveConnIdDispatchRoutesPacketToActiveSession) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"192.168.1.70", 40020};
+  const auto endpoint = make_endpoint("192.168.1.70", 40020);
 
   const auto syn =
       encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 77);
@@ -143,8 +170,8 @@ TEST(ServerSessionManagerTest, ActiveConnIdDispatchRoutesPacketToActiveSession)
 
 TEST(ServerSessionManagerTest, ActiveConnIdFromDifferentEndpointIsDropped) {
   ServerSessionManager manager;
-  const EndpointKey bound_endpoint{"192.168.1.71", 40021};
-  const EndpointKey mismatched_endpoint{"192.168.1.72", 40022};
+  const auto bound_endpoint = make_endpoint("192.168.1.71", 40021);
+  const auto mismatched_endpoint = make_endpoint("192.168.1.72", 40022);
 
   const auto syn =
       encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 77);
@@ -182,7 +209,7 @@ TEST(ServerSessionManagerTest, ActiveConnIdFromDifferentEndpointIsDropped) {
 
 TEST(ServerSessionManagerTest, UnknownPeerCreatesPendingSessionBeforeHandshake) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"192.168.1.99", 41000};
+  const auto endpoint = make_endpoint("192.168.1.99", 41000);
 
   const auto fin =
       encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Fin), 0, 12);
@@ -199,7 +226,7 @@ TEST(ServerSessionManagerTest, UnknownPeerCreatesPendingSessionBeforeHandshake)
 TEST(ServerSessionManagerTest,
      UnknownPeerUnreliableDoesNotLeaveClosedPendingSessionBehind) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"10.0.0.7", 42000};
+  const auto endpoint = make_endpoint("10.0.0.7", 42000);
 
   const Rudp::Header header{
       .conn_id = 0,
@@ -225,7 +252,7 @@ TEST(ServerSessionManagerTest,
 
 TEST(ServerSessionManagerTest, UnknownNonZeroConnIdPacketIsDropped) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"172.16.0.8", 43000};
+  const auto endpoint = make_endpoint("172.16.0.8", 43000);
 
   const Rudp::Header header{
       .conn_id = 0x12345678U,
@@ -251,7 +278,7 @@ TEST(ServerSessionManagerTest, UnknownNonZeroConnIdPacketIsDropped) {
 
 TEST(ServerSessionManagerTest, PendingSessionResetIsCleanedUpImmediately) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"172.16.0.9", 43001};
+  const auto endpoint = make_endpoint("172.16.0.9", 43001);
 
   const auto syn =
       encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 90);
@@ -270,7 +297,7 @@ TEST(ServerSessionManagerTest, PendingSessionResetIsCleanedUpImmediately) {
 
 TEST(ServerSessionManagerTest, ActiveSessionResetIsCleanedUpImmediately) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"172.16.0.10", 43002};
+  const auto endpoint = make_endpoint("172.16.0.10", 43002);
 
   const auto syn =
       encode_control_datagram(static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 91);
@@ -298,8 +325,8 @@ TEST(ServerSessionManagerTest, RetiredConnIdsAreNotReused) {
   std::vector<std::uint32_t> assigned_conn_ids;
 
   for (std::uint16_t i = 0; i < 8; ++i) {
-    const EndpointKey endpoint{"172.16.1.1",
-                               static_cast<std::uint16_t>(44010 + i)};
+    const auto endpoint =
+        make_endpoint("172.16.1.1", static_cast<std::uint16_t>(44010 + i));
     const auto syn = encode_control_datagram(
         static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 100U + i);
     manager.on_datagram_received(endpoint, syn, 100U + i);
@@ -320,10 +347,105 @@ TEST(ServerSessionManagerTest, RetiredConnIdsAreNotReused) {
   EXPECT_EQ(duplicate_it, assigned_conn_ids.end());
 }
 
+TEST(ServerSessionManagerTest, RetiredConnIdsAreBoundedAndExpire) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous = settings.transport;
+  settings.transport.retired_conn_id_quiet_ms = 1000U;
+  settings.transport.max_retired_conn_ids = 4U;
+  ServerSessionManager manager;
+
+  for (std::uint16_t i = 0; i < 6; ++i) {
+    const auto endpoint =
+        make_endpoint("172.16.1.2", static_cast<std::uint16_t>(44030 + i));
+    const auto syn = encode_control_datagram(
+        static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 100U + i);
+    manager.on_datagram_received(endpoint, syn, 100U + i);
+    const auto conn_id = manager.pending_conn_id(endpoint);
+    ASSERT_TRUE(conn_id.has_value());
+    const auto rst = encode_control_datagram(
+        static_cast<Rudp::Flags>(Rudp::Flag::Rst), *conn_id, 0);
+    manager.on_datagram_received(endpoint, rst, 200U + i);
+  }
+  EXPECT_EQ(manager.retired_conn_id_count(), 4U);
+
+  // Ids retired at 202..205 ms; the first two quiet periods end by 1203 ms.
+  OutboundBatch batch;
+  static_cast<void>(manager.poll_tx_batch(1203U, 1U, batch));
+  EXPECT_EQ(manager.retired_conn_id_count(), 2U);
+  static_cast<void>(manager.poll_tx_batch(1205U, 1U, batch));
+  EXPECT_EQ(manager.retired_conn_id_count(), 0U);
+
+  settings.transport = previous;
+}
+
+TEST(RetiredConnIdsTest, ReservesIdsUntilTheirQuietPeriodEnds) {
+  RetiredConnIds retired(100U, 8U);
+  retired.retire(7U, 1000U);
+  retired.retire(9U, 1050U);
+
+  retired.expire(1099U);
+  EXPECT_TRUE(retired.contains(7U));
+  retired.expire(1100U);
+  EXPECT_FALSE(retired.contains(7U));
+  EXPECT_TRUE(retired.contains(9U));
+  retired.expire(1150U);
+  EXPECT_EQ(retired.size(), 0U);
+}
+
+// Verifies that in cookie mode a SYN leaves no state behind, and that the
+// session appears only once the client echoes an intact cookie.
+TEST(ServerSessionManagerTest, CookieHandshakeAllocatesSessionOnEcho) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous = settings.transport;
+  settings.transport.enable_handshake_cookies = true;
+  ServerSessionManager manager;
+  const auto endpoint = make_endpoint("172.16.2.1", 45000);
+
+  Session client(SessionRole::Client, 500U);
+  const auto syn = client.poll_tx(100U);
+  ASSERT_TRUE(syn.has_value());
+  manager.on_datagram_received(endpoint, *syn, 100U);
+  EXPECT_EQ(manager.pending_session_count(), 0U);
+  EXPECT_EQ(manager.active_session_count(), 0U);
+
+  const auto replies = manager.poll_tx(100U);
+  ASSERT_EQ(replies.size(), 1U);
+  client.on_datagram_received(replies[0].bytes, 110U);
+  ASSERT_EQ(client.connection_state(), ConnectionState::Established);
+  const auto final_ack = client.poll_tx(110U);
+  ASSERT_TRUE(final_ack.has_value());
+
+  auto forged = *final_ack;
+  forged.back() ^= std::byte{0x01};
+  manager.on_datagram_received(endpoint, forged, 120U);
+  EXPECT_EQ(manager.active_session_count(), 0U);
+  manager.on_datagram_received(make_endpoint("172.16.2.2", 45000), *final_ack,
+                               120U);
+  EXPECT_EQ(manager.active_session_count(), 0U);
+
+  manager.on_datagram_received(endpoint, *final_ack, 120U);
+  ASSERT_TRUE(manager.has_active_session(client.conn_id()));
+  EXPECT_EQ(manager.active_conn_id(endpoint), client.conn_id());
+  const auto events = manager.drain_events();
+  ASSERT_EQ(events.size(), 1U);
+  EXPECT_EQ(events[0].event.type, SessionEvent::Type::Connected);
+
+  const std::array message = {std::byte{0x33}};
+  client.queue_send(2U, Rudp::ChannelType::ReliableUnordered, message);
+  const auto data = client.poll_tx(130U);
+  ASSERT_TRUE(data.has_value());
+  manager.on_datagram_received(endpoint, *data, 130U);
+  const auto received = manager.drain_events();
+  ASSERT_EQ(received.size(), 1U);
+  EXPECT_EQ(received[0].event.type, SessionEvent::Type::DataReceived);
+
+  settings.transport = previous;
+}
+
 TEST(ServerSessionManagerTest, PollTxCollectsAtMostOneDatagramPerSession) {
   ServerSessionManager manager;
-  const EndpointKey pending_endpoint{"192.168.2.10", 44000};
-  const EndpointKey active_endpoint{"192.168.2.11", 44001};
+  const auto pending_endpoint = make_endpoint("192.168.2.10", 44000);
+  const auto active_endpoint = make_endpoint("192.168.2.11", 44001);
 
   const auto pending_syn = encode_control_datagram(
       static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 100);
@@ -384,7 +506,7 @@ TEST(ServerSessionManagerTest, PollTxCollectsAtMostOneDatagramPerSession) {
 
 TEST(ServerSessionManagerTest, QueueSendTargetsActiveSession) {
   ServerSessionManager manager;
-  const EndpointKey endpoint{"192.168.2.12", 44002};
+  const auto endpoint = make_endpoint("192.168.2.12", 44002);
 
   const auto syn = encode_control_datagram(
       static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 300);
@@ -417,4 +539,108 @@ TEST(ServerSessionManagerTest, QueueSendTargetsActiveSession) {
   ASSERT_EQ(decoded->payload.size(), message.size());
 }
 
+TEST(ServerSessionManagerTest, PollTxBatchDrainsUpToBudgetPerSession) {
+  ServerSessionManager manager;
+  const auto endpoint = make_endpoint("192.168.2.13", 44003);
+
+  const auto syn = encode_control_datagram(
+      static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 400);
+  manager.on_datagram_received(endpoint, syn, 100U);
+  const auto conn_id = manager.pending_conn_id(endpoint);
+  ASSERT_TRUE(conn_id.has_value());
+  const auto final_ack = encode_control_datagram(
+      static_cast<Rudp::Flags>(Rudp::Flag::Ack), *conn_id, 401);
+  manager.on_datagram_received(endpoint, final_ack, 110U);
+  ASSERT_TRUE(manager.has_active_session(*conn_id));
+
+  const std::array payload = {std::byte{0x0a}, std::byte{0x0b}};
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(manager.queue_send(*conn_id, 2U, Rudp::ChannelType::Unreliable,
+                                   payload));
+  }
+
+  OutboundBatch batch;
+  EXPECT_EQ(manager.poll_tx_batch(120U, 3U, batch), 3U);
+  ASSERT_EQ(batch.size(), 3U);
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    EXPECT_EQ(batch.endpoints[i], endpoint);
+    const auto decoded = Rudp::Codec::decode(batch.datagrams[i]);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->header.channel_id, 2U);
+    EXPECT_EQ(decoded->payload.size(), payload.size());
+  }
+
+  // A session that used its whole budget stays ready for the next pass,
+  // which appends after what the batch already holds.
+  EXPECT_EQ(manager.next_deadline_ms(120U),
+            std::optional<std::uint64_t>(120U));
+  EXPECT_EQ(manager.poll_tx_batch(120U, 3U, batch), 2U);
+  EXPECT_EQ(batch.size(), 5U);
+
+  batch.clear();
+  EXPECT_TRUE(batch.empty());
+  EXPECT_TRUE(batch.datagrams.empty());
+}
+
+TEST(EndpointKeyTest, ParsesAndFormatsNumericAddresses) {
+  const auto v4 = EndpointKey::parse("10.1.2.3", 9000);
+  ASSERT_TRUE(v4.has_value());
+  EXPECT_EQ(v4->family, AddressFamily::IPv4);
+  EXPECT_EQ(*v4, EndpointKey::ipv4(0x0A010203U, 9000));
+  EXPECT_EQ(v4->to_string(), "10.1.2.3:9000");
+
+  const auto v6 = EndpointKey::parse("::1", 9001);
+  ASSERT_TRUE(v6.has_value());
+  EXPECT_EQ(v6->family, AddressFamily::IPv6);
+  EXPECT_EQ(v6->to_string(), "[::1]:9001");
+
+  EXPECT_FALSE(EndpointKey::parse("not-an-address", 9000).has_value());
+}
+
+TEST(EndpointKeyTest, EqualityAndHashCoverPortAndFamily) {
+  const auto base = make_endpoint("10.1.2.3", 9000);
+  const auto other_port = make_endpoint("10.1.2.3", 9001);
+  auto other_family = base;
+  other_family.family = AddressFamily::IPv6;
+
+  const EndpointKeyHash hash;
+  EXPECT_EQ(hash(base), hash(make_endpoint("10.1.2.3", 9000)));
+  EXPECT_NE(base, other_port);
+  EXPECT_NE(base, other_family);
+  EXPECT_NE(hash(base), hash(other_port));
+}
+
+TEST(ServerSessionManagerTest, IdleSessionsWaitForTheirTimerBeforeBeingPolled) {
+  ServerSessionManager manager;
+  const auto endpoint = make_endpoint("192.168.3.10", 45000);
+
+  const auto syn = encode_control_datagram(
+      static_cast<Rudp::Flags>(Rudp::Flag::Syn), 0, 500);
+  manager.on_datagram_received(endpoint, syn, 100U);
+  EXPECT_EQ(manager.next_deadline_ms(100U), std::optional<std::uint64_t>(100U));
+
+  const auto syn_ack = manager.poll_tx(100U);
+  ASSERT_EQ(syn_ack.size(), 1U);
+
+  // Follow the reported deadlines the way the event loop does; cascade
+  // points may wake it early, but nothing is emitted before the RTO.
+  const auto rto_at = 100U + Rudp::Config::current().transport.initial_rto_ms;
+  std::uint64_t now = 100U;
+  std::vector<OutboundDatagram> retransmitted;
+  while (retransmitted.empty()) {
+    const auto next = manager.next_deadline_ms(now);
+    ASSERT_TRUE(next.has_value());
+    ASSERT_GT(*next, now);
+    ASSERT_LE(*next, rto_at);
+    now = *next;
+    retransmitted = manager.poll_tx(now);
+  }
+  EXPECT_EQ(now, rto_at);
+  ASSERT_EQ(retransmitted.size(), 1U);
+  const auto decoded = Rudp::Codec::decode(retransmitted.front().bytes);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_TRUE(decoded->header.hasFlag(Rudp::Flag::Syn));
+  EXPECT_TRUE(decoded->header.hasFlag(Rudp::Flag::Ack));
+}
+
 }  // namespace Rudp::Session
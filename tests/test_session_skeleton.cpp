@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -151,6 +152,53 @@ TEST(SessionSkeletonTest, QueueSendPollTxProducesPacketForUnreliableData) {
   ASSERT_EQ(decoded->payload.size(), payload.size());
 }
 
+// Verifies poll_tx_into leaves queued data in place when the caller buffer is
+// too small and writes the datagram once given max_datagram_size() bytes.
+TEST(SessionSkeletonTest, PollTxIntoRequiresBufferLargeEnoughForDatagram) {
+  Session session(SessionRole::Server);
+
+  const std::array payload = {std::byte{0x01}, std::byte{0x02},
+                              std::byte{0x03}};
+  session.queue_send(7U, Rudp::ChannelType::Unreliable, payload);
+
+  std::array<std::byte, Rudp::kHeaderLength> small{};
+  EXPECT_FALSE(session.poll_tx_into(small, 100U).has_value());
+
+  std::vector<std::byte> buffer(session.max_datagram_size());
+  const auto written = session.poll_tx_into(buffer, 100U);
+  ASSERT_TRUE(written.has_value());
+  const auto decoded = Rudp::Codec::decode(
+      std::span<const std::byte>(buffer.data(), *written));
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->header.channel_id, 7U);
+  ASSERT_EQ(decoded->payload.size(), payload.size());
+  EXPECT_FALSE(session.poll_tx_into(buffer, 100U).has_value());
+}
+
+// Verifies poll_tx_batch packs several datagrams into one arena, stops at the
+// budget, and reports a short count once the send queue is empty.
+TEST(SessionSkeletonTest, PollTxBatchFillsArenaUpToBudget) {
+  Session session(SessionRole::Server);
+
+  for (std::uint8_t i = 0; i < 3U; ++i) {
+    const std::array payload = {std::byte{i}, std::byte{0xee}};
+    session.queue_send(7U, Rudp::ChannelType::Unreliable, payload);
+  }
+
+  Rudp::Session::DatagramArena arena(64U);
+  EXPECT_EQ(session.poll_tx_batch(100U, 2U, arena), 2U);
+  EXPECT_EQ(session.poll_tx_batch(100U, 2U, arena), 1U);
+  ASSERT_EQ(arena.size(), 3U);
+  for (std::size_t i = 0; i < arena.size(); ++i) {
+    const auto decoded = Rudp::Codec::decode(arena[i]);
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_EQ(decoded->payload.size(), 2U);
+    EXPECT_EQ(decoded->payload[0], std::byte{static_cast<std::uint8_t>(i)});
+  }
+  EXPECT_EQ(session.stats().packets_sent, 3U);
+  EXPECT_EQ(session.poll_tx_batch(100U, 2U, arena), 0U);
+}
+
 // Verifies receiving an unreliable datagram produces a single DataReceived
 // event carrying the original channel metadata and payload.
 TEST(SessionSkeletonTest, ReceiveUnreliableDatagramCreatesDataEvent) {
@@ -964,4 +1012,280 @@ TEST(SessionSkeletonTest, RetryLimitExceededTransitionsSessionToReset) {
   EXPECT_EQ(events.front().error_message, "retransmission retry limit exceeded");
 }
 
+// Verifies next_deadline_ms() reports immediate work for a fresh client and the
+// SYN retransmission timeout once the SYN is in flight.
+TEST(SessionSkeletonTest, NextDeadlineTracksHandshakeRetransmitTimeout) {
+  Session client;
+  EXPECT_EQ(client.next_deadline_ms(100U), std::optional<std::uint64_t>(100U));
+
+  const auto syn = client.poll_tx(100U);
+  ASSERT_TRUE(syn.has_value());
+  const auto retransmit_at = client.next_deadline_ms(100U);
+  ASSERT_TRUE(retransmit_at.has_value());
+  EXPECT_EQ(*retransmit_at,
+            100U + Rudp::Config::current().transport.initial_rto_ms);
+
+  EXPECT_FALSE(client.poll_tx(*retransmit_at - 1U).has_value());
+  const auto retry_header = decode_header_or_die(client.poll_tx(*retransmit_at));
+  EXPECT_TRUE(retry_header.hasFlag(Rudp::Flag::Syn));
+}
+
+// Verifies the reported deadline is exactly when delayed ACKs and keepalive
+// pings become due, so an event loop can sleep until then.
+TEST(SessionSkeletonTest, NextDeadlineMatchesDelayedAckAndKeepalive) {
+  Session client;
+  Session server(SessionRole::Server);
+  establish_connection(client, server);
+  static_cast<void>(client.drain_events());
+  static_cast<void>(server.drain_events());
+
+  const auto ping_at = client.next_deadline_ms(200U);
+  ASSERT_TRUE(ping_at.has_value());
+  EXPECT_GT(*ping_at, 200U);
+  EXPECT_FALSE(client.poll_tx(*ping_at - 1U).has_value());
+  const auto ping_header = decode_header_or_die(client.poll_tx(*ping_at));
+  EXPECT_TRUE(ping_header.hasFlag(Rudp::Flag::Ping));
+
+  const auto* text = reinterpret_cast<const std::byte*>("r");
+  client.queue_send(7U, Rudp::ChannelType::ReliableUnordered,
+                    std::span<const std::byte>(text, 1U));
+  EXPECT_EQ(client.next_deadline_ms(*ping_at),
+            std::optional<std::uint64_t>(*ping_at));
+  const auto reliable_data = client.poll_tx(*ping_at);
+  ASSERT_TRUE(reliable_data.has_value());
+
+  server.on_datagram_received(*reliable_data, 300U);
+  EXPECT_EQ(server.next_deadline_ms(300U),
+            std::optional<std::uint64_t>(
+                300U + Rudp::Config::current().transport.reliable_ack_delay_ms));
+}
+
+// Verifies a window negotiated above 64 lets more than 64 reliable packets be
+// in flight, and that the receiver reports packets past the AckBits bitmap as
+// SACK ranges which release them at the sender.
+TEST(SessionSkeletonTest, NegotiatedLargeWindowIsAcknowledgedWithSackRanges) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous_window = settings.transport.reliable_window_packets;
+  settings.transport.reliable_window_packets = 256U;
+
+  Session client;
+  Session server(SessionRole::Server);
+  establish_connection(client, server);
+  static_cast<void>(client.drain_events());
+  static_cast<void>(server.drain_events());
+
+  constexpr std::uint32_t kPacketCount = 200U;
+  const auto* text = reinterpret_cast<const std::byte*>("w");
+  for (std::uint32_t i = 0; i < kPacketCount; ++i) {
+    client.queue_send(7U, Rudp::ChannelType::ReliableUnordered,
+                      std::span<const std::byte>(text, 1U));
+  }
+  std::vector<std::vector<std::byte>> sent;
+  while (auto datagram = client.poll_tx(300U)) {
+    sent.push_back(std::move(*datagram));
+  }
+  ASSERT_EQ(sent.size(), kPacketCount);
+  const auto first_seq = decode_header_or_die(sent.front()).seq;
+
+  for (std::size_t i = 1; i < sent.size(); ++i) {
+    server.on_datagram_received(sent[i], 310U);
+  }
+  const auto ack = server.poll_tx(
+      310U + Rudp::Config::current().transport.reliable_ack_delay_ms);
+  ASSERT_TRUE(ack.has_value());
+  const auto decoded = Rudp::Codec::decode(*ack);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->header.ack, first_seq);
+  EXPECT_EQ(decoded->header.ack_bits, ~0ULL);
+  const auto extensions = Rudp::Codec::decode_extensions(decoded->extensions);
+  ASSERT_TRUE(extensions.has_value());
+  ASSERT_EQ(extensions->sacks().size(), 1U);
+  EXPECT_EQ(extensions->sacks()[0].begin,
+            first_seq + static_cast<std::uint32_t>(Rudp::kAckBitsWindow) + 1U);
+  EXPECT_EQ(extensions->sacks()[0].end, first_seq + kPacketCount);
+
+  client.on_datagram_received(*ack, 320U);
+  const auto retransmit_at =
+      300U + Rudp::Config::current().transport.initial_rto_ms;
+  const auto retransmit = client.poll_tx(retransmit_at);
+  EXPECT_EQ(decode_header_or_die(retransmit).seq, first_seq);
+  EXPECT_FALSE(client.poll_tx(retransmit_at).has_value());
+  EXPECT_EQ(client.stats().retransmissions_sent, 1U);
+
+  settings.transport.reliable_window_packets = previous_window;
+}
+
+// Verifies that once both peers offer bundling, small messages queued for one
+// channel leave in a single datagram and arrive as separate events.
+TEST(SessionSkeletonTest, NegotiatedBundlingPacksSmallMessagesIntoOneDatagram) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous_bundling = settings.transport.enable_bundling;
+  settings.transport.enable_bundling = true;
+
+  Session client;
+  Session server(SessionRole::Server);
+  establish_connection(client, server);
+  static_cast<void>(client.drain_events());
+  static_cast<void>(server.drain_events());
+
+  const std::array payload = {std::byte{0x10}, std::byte{0x20}};
+  for (int i = 0; i < 3; ++i) {
+    client.queue_send(4U, Rudp::ChannelType::ReliableOrdered, payload);
+  }
+  client.queue_send(5U, Rudp::ChannelType::ReliableOrdered, payload);
+
+  const auto bundle = client.poll_tx(300U);
+  ASSERT_TRUE(bundle.has_value());
+  EXPECT_TRUE(decode_header_or_die(bundle).hasFlag(Rudp::Flag::Bundle));
+  const auto single = client.poll_tx(300U);
+  ASSERT_TRUE(single.has_value());
+  EXPECT_FALSE(decode_header_or_die(single).hasFlag(Rudp::Flag::Bundle));
+
+  server.on_datagram_received(*bundle, 310U);
+  server.on_datagram_received(*single, 310U);
+  const auto events = server.drain_events();
+  log_events("server after bundled data", events);
+  ASSERT_EQ(events.size(), 4U);
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(events[i].type, SessionEvent::Type::DataReceived);
+    EXPECT_EQ(events[i].channel_id, i < 3U ? 4U : 5U);
+    EXPECT_EQ(events[i].payload.size(), payload.size());
+  }
+
+  settings.transport.enable_bundling = previous_bundling;
+}
+
+// Verifies bundling stays off when only one side offers it.
+TEST(SessionSkeletonTest, BundlingRequiresBothPeersToOfferIt) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous_bundling = settings.transport.enable_bundling;
+  settings.transport.enable_bundling = true;
+  Session client;
+  settings.transport.enable_bundling = previous_bundling;
+  Session server(SessionRole::Server);
+  establish_connection(client, server);
+
+  const std::array payload = {std::byte{0x10}};
+  client.queue_send(4U, Rudp::ChannelType::Unreliable, payload);
+  client.queue_send(4U, Rudp::ChannelType::Unreliable, payload);
+
+  EXPECT_FALSE(decode_header_or_die(client.poll_tx(300U))
+                   .hasFlag(Rudp::Flag::Bundle));
+  EXPECT_TRUE(client.poll_tx(300U).has_value());
+}
+
+// Verifies a reliable message larger than one datagram is split into
+// fragments within max_datagram_bytes and reassembled into a single event,
+// in order with the messages around it, even when fragments arrive out of
+// order.
+TEST(SessionSkeletonTest, NegotiatedFragmentationReassemblesLargeMessage) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous_fragmentation = settings.transport.enable_fragmentation;
+  settings.transport.enable_fragmentation = true;
+
+  Session client;
+  Session server(SessionRole::Server);
+  establish_connection(client, server);
+  static_cast<void>(client.drain_events());
+  static_cast<void>(server.drain_events());
+
+  std::vector<std::byte> large(5000U);
+  for (std::size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<std::byte>(i * 7U);
+  }
+  const std::array small = {std::byte{0x55}};
+  client.queue_send(3U, Rudp::ChannelType::ReliableOrdered, large);
+  client.queue_send(3U, Rudp::ChannelType::ReliableOrdered, small);
+
+  std::vector<std::vector<std::byte>> sent;
+  while (auto datagram = client.poll_tx(300U)) {
+    EXPECT_LE(datagram->size(), settings.transport.max_datagram_bytes);
+    sent.push_back(std::move(*datagram));
+  }
+  ASSERT_EQ(sent.size(), 6U);
+  server.on_datagram_received(sent.front(), 310U);
+  for (auto it = sent.rbegin(); it + 1 != sent.rend(); ++it) {
+    server.on_datagram_received(*it, 310U);
+  }
+
+  const auto events = server.drain_events();
+  log_events("server after fragmented data", events);
+  ASSERT_EQ(events.size(), 2U);
+  EXPECT_EQ(events[0].payload, large);
+  EXPECT_EQ(events[1].payload.size(), small.size());
+
+  settings.transport.enable_fragmentation = previous_fragmentation;
+}
+
+// Verifies a fragment that would exceed the receiver's reassembly budget is
+// dropped unacknowledged instead of being buffered.
+TEST(SessionSkeletonTest, FragmentPastReassemblyBudgetIsNotAcknowledged) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous_fragmentation = settings.transport.enable_fragmentation;
+  const auto previous_budget = settings.transport.max_reassembly_bytes;
+  settings.transport.enable_fragmentation = true;
+  settings.transport.max_reassembly_bytes = 2000U;
+
+  Session client;
+  Session server(SessionRole::Server);
+  establish_connection(client, server);
+  static_cast<void>(server.drain_events());
+
+  const std::vector<std::byte> large(3000U, std::byte{0x01});
+  client.queue_send(3U, Rudp::ChannelType::ReliableUnordered, large);
+  const auto fragment = client.poll_tx(300U);
+  ASSERT_TRUE(fragment.has_value());
+  ASSERT_TRUE(decode_header_or_die(fragment).hasFlag(Rudp::Flag::Fragment));
+
+  server.on_datagram_received(*fragment, 310U);
+  EXPECT_TRUE(server.drain_events().empty());
+  EXPECT_FALSE(server.poll_tx(
+      310U + Rudp::Config::current().transport.reliable_ack_delay_ms));
+
+  settings.transport.enable_fragmentation = previous_fragmentation;
+  settings.transport.max_reassembly_bytes = previous_budget;
+}
+
+// Verifies that with ordered streams agreed, a lost packet on one ordered
+// channel does not delay another, and its retransmission keeps its STREAM_SEQ.
+TEST(SessionSkeletonTest, OrderedStreamsDeliverChannelsIndependently) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous_streams = settings.transport.enable_ordered_streams;
+  settings.transport.enable_ordered_streams = true;
+
+  Session client;
+  Session server(SessionRole::Server);
+  establish_connection(client, server);
+  static_cast<void>(server.drain_events());
+
+  const std::array payload = {std::byte{0x01}};
+  client.queue_send(1U, Rudp::ChannelType::ReliableOrdered, payload);
+  client.queue_send(2U, Rudp::ChannelType::ReliableOrdered, payload);
+  const auto lost = client.poll_tx(300U);
+  const auto delivered = client.poll_tx(300U);
+  ASSERT_TRUE(lost.has_value());
+  ASSERT_TRUE(delivered.has_value());
+
+  server.on_datagram_received(*delivered, 310U);
+  const auto first_events = server.drain_events();
+  ASSERT_EQ(first_events.size(), 1U);
+  EXPECT_EQ(first_events[0].channel_id, 2U);
+
+  const auto retransmit =
+      client.poll_tx(300U + Rudp::Config::current().transport.initial_rto_ms);
+  ASSERT_TRUE(retransmit.has_value());
+  const auto decoded = Rudp::Codec::decode(*retransmit);
+  ASSERT_TRUE(decoded.has_value());
+  const auto extensions = Rudp::Codec::decode_extensions(decoded->extensions);
+  ASSERT_TRUE(extensions.has_value());
+  EXPECT_EQ(extensions->stream_seq, std::optional<std::uint32_t>(0U));
+
+  server.on_datagram_received(*retransmit, 320U);
+  const auto second_events = server.drain_events();
+  ASSERT_EQ(second_events.size(), 1U);
+  EXPECT_EQ(second_events[0].channel_id, 1U);
+
+  settings.transport.enable_ordered_streams = previous_streams;
+}
+
 }  // namespace
@@ -0,0 +1,41 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Rudp/SessionSlab.hpp"
+
+namespace {
+
+using Rudp::Session::Session;
+using Rudp::Session::SessionRole;
+using Rudp::Session::SessionSlab;
+
+// Verifies sessions keep their address while the slab grows past a chunk,
+// and that a freed slot is the next one handed out.
+TEST(SessionSlabTest, SlotsStayPutAndFreedSlotsAreReusedFirst) {
+  SessionSlab slab;
+  std::vector<SessionSlab::Handle> handles;
+  std::vector<const Session*> addresses;
+  for (std::uint32_t i = 0; i < SessionSlab::kChunkSlots + 1U; ++i) {
+    handles.push_back(slab.emplace(SessionRole::Server, i));
+    slab[handles.back()].assign_conn_id(i + 1U);
+    addresses.push_back(&slab[handles.back()]);
+  }
+  EXPECT_EQ(slab.size(), SessionSlab::kChunkSlots + 1U);
+  EXPECT_EQ(slab.capacity(), 2U * SessionSlab::kChunkSlots);
+  for (std::size_t i = 0; i < handles.size(); ++i) {
+    EXPECT_EQ(&slab[handles[i]], addresses[i]);
+    EXPECT_EQ(slab[handles[i]].conn_id(), i + 1U);
+  }
+
+  slab.erase(handles[3]);
+  slab.erase(handles[3]);
+  EXPECT_EQ(slab.size(), SessionSlab::kChunkSlots);
+  const auto reused = slab.emplace(SessionRole::Server);
+  EXPECT_EQ(reused, handles[3]);
+  EXPECT_EQ(slab[reused].conn_id(), 0U);
+  EXPECT_EQ(slab.capacity(), 2U * SessionSlab::kChunkSlots);
+}
+
+}  // namespace
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Rudp/TimerWheel.hpp"
+
+namespace {
+
+using Rudp::Session::TimerWheel;
+
+[[nodiscard]] std::vector<std::uint32_t> advance_to(TimerWheel& wheel,
+                                                    std::uint64_t now_ms) {
+  std::vector<std::uint32_t> expired;
+  wheel.advance(now_ms, expired);
+  std::sort(expired.begin(), expired.end());
+  return expired;
+}
+
+// Verifies timers fire exactly at their deadline across every wheel level,
+// including deadlines that need several cascades to reach level 0.
+TEST(TimerWheelTest, ExpiresEachTimerExactlyAtItsDeadline) {
+  TimerWheel wheel(1'000U);
+  const std::vector<std::uint64_t> offsets = {1U,     63U,     64U,
+                                              4'095U, 4'096U,  300'000U,
+                                              20'000'000U};
+  for (std::uint32_t id = 0; id < offsets.size(); ++id) {
+    wheel.schedule(id + 1U, 1'000U + offsets[id]);
+  }
+
+  for (std::uint32_t id = 0; id < offsets.size(); ++id) {
+    const auto deadline = 1'000U + offsets[id];
+    EXPECT_TRUE(advance_to(wheel, deadline - 1U).empty())
+        << "timer " << id + 1U << " fired early";
+    EXPECT_EQ(advance_to(wheel, deadline), std::vector<std::uint32_t>{id + 1U});
+  }
+  EXPECT_TRUE(wheel.empty());
+}
+
+// Verifies rescheduling and cancelling leave no stale expirations behind.
+TEST(TimerWheelTest, RescheduleAndCancelAreLazyButExact) {
+  TimerWheel wheel(0U);
+  wheel.schedule(1U, 50U);
+  wheel.schedule(2U, 60U);
+  wheel.schedule(1U, 5'000U);
+  wheel.cancel(2U);
+
+  EXPECT_TRUE(advance_to(wheel, 4'999U).empty());
+  EXPECT_EQ(advance_to(wheel, 5'000U), std::vector<std::uint32_t>{1U});
+  EXPECT_TRUE(wheel.empty());
+}
+
+// Verifies a deadline already in the past fires on the next advance and that
+// a single large advance collects everything due in between.
+TEST(TimerWheelTest, PastDeadlinesAndLargeJumpsExpireTogether) {
+  TimerWheel wheel(100U);
+  wheel.schedule(7U, 90U);
+  wheel.schedule(8U, 150U);
+  wheel.schedule(9U, 1'000'000U);
+
+  EXPECT_EQ(advance_to(wheel, 100U), std::vector<std::uint32_t>{7U});
+  EXPECT_EQ(advance_to(wheel, 2'000'000U), (std::vector<std::uint32_t>{8U, 9U}));
+}
+
+// Verifies next_deadline_ms() never reports a time later than the earliest
+// pending deadline, so a loop sleeping until it cannot miss a timer.
+TEST(TimerWheelTest, NextDeadlineNeverOvershoots) {
+  TimerWheel wheel(10U);
+  EXPECT_EQ(wheel.next_deadline_ms(), std::nullopt);
+
+  wheel.schedule(1U, 40U);
+  EXPECT_EQ(wheel.next_deadline_ms(), std::optional<std::uint64_t>(40U));
+
+  wheel.schedule(2U, 30'000U);
+  wheel.cancel(1U);
+  std::uint64_t now = 10U;
+  std::vector<std::uint32_t> expired;
+  while (expired.empty()) {
+    const auto next = wheel.next_deadline_ms();
+    ASSERT_TRUE(next.has_value());
+    ASSERT_LE(*next, 30'000U);
+    ASSERT_GT(*next, now);
+    now = *next;
+    wheel.advance(now, expired);
+  }
+  EXPECT_EQ(now, 30'000U);
+  EXPECT_EQ(expired, std::vector<std::uint32_t>{2U});
+}
+
+}  // namespace
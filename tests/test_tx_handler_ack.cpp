@@ -1,5 +1,6 @@
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -14,6 +15,7 @@ using Rudp::Session::OwnedPacket;
 using Rudp::Session::TxEntry;
 using Rudp::Session::TxHandler;
 using Rudp::Session::ConnectionState;
+using Rudp::Session::ControlKind;
 using Rudp::Session::RxSessionState;
 using Rudp::Session::SessionRole;
 using Rudp::Session::TxSessionState;
@@ -52,23 +54,23 @@ TEST(TxHandlerAckTest, AckBitsGapDetectionMarksMultipleMissingPackets) {
       (1ULL << 1U) | (1ULL << 2U) | (1ULL << 3U) | (1ULL << 5U) |
       (1ULL << 6U);
 
-  static_cast<void>(handler.on_remote_ack(ack, ack_bits, tx));
+  static_cast<void>(handler.on_remote_ack(ack, ack_bits, 0U, tx));
 
   EXPECT_EQ(tx.remote_ack, ack);
   EXPECT_EQ(tx.remote_ack_bits, ack_bits);
 
-  ASSERT_NE(tx.inflight.find(100U), tx.inflight.end());
-  ASSERT_NE(tx.inflight.find(101U), tx.inflight.end());
-  ASSERT_NE(tx.inflight.find(105U), tx.inflight.end());
+  ASSERT_TRUE(tx.inflight.contains(100U));
+  ASSERT_TRUE(tx.inflight.contains(101U));
+  ASSERT_TRUE(tx.inflight.contains(105U));
   EXPECT_TRUE(tx.inflight.at(100U).fast_retx_pending);
   EXPECT_TRUE(tx.inflight.at(101U).fast_retx_pending);
   EXPECT_TRUE(tx.inflight.at(105U).fast_retx_pending);
 
-  EXPECT_EQ(tx.inflight.find(102U), tx.inflight.end());
-  EXPECT_EQ(tx.inflight.find(103U), tx.inflight.end());
-  EXPECT_EQ(tx.inflight.find(104U), tx.inflight.end());
-  EXPECT_EQ(tx.inflight.find(106U), tx.inflight.end());
-  EXPECT_EQ(tx.inflight.find(107U), tx.inflight.end());
+  EXPECT_FALSE(tx.inflight.contains(102U));
+  EXPECT_FALSE(tx.inflight.contains(103U));
+  EXPECT_FALSE(tx.inflight.contains(104U));
+  EXPECT_FALSE(tx.inflight.contains(106U));
+  EXPECT_FALSE(tx.inflight.contains(107U));
 
   settings.transport.fast_retx_evidence_threshold = previous_threshold;
 }
@@ -80,11 +82,11 @@ TEST(TxHandlerAckTest, ZeroAckBitsDoesNotMarkFastRetransmitCandidates) {
   TxSessionState tx;
   seed_inflight(tx, {100U, 101U, 102U});
 
-  static_cast<void>(handler.on_remote_ack(100U, 0ULL, tx));
+  static_cast<void>(handler.on_remote_ack(100U, 0ULL, 0U, tx));
 
-  ASSERT_NE(tx.inflight.find(100U), tx.inflight.end());
-  ASSERT_NE(tx.inflight.find(101U), tx.inflight.end());
-  ASSERT_NE(tx.inflight.find(102U), tx.inflight.end());
+  ASSERT_TRUE(tx.inflight.contains(100U));
+  ASSERT_TRUE(tx.inflight.contains(101U));
+  ASSERT_TRUE(tx.inflight.contains(102U));
   EXPECT_FALSE(tx.inflight.at(100U).fast_retx_pending);
   EXPECT_FALSE(tx.inflight.at(101U).fast_retx_pending);
   EXPECT_FALSE(tx.inflight.at(102U).fast_retx_pending);
@@ -103,13 +105,13 @@ TEST(TxHandlerAckTest, GapEvidenceThresholdDelaysFastRetransmitMarking) {
   const std::uint32_t ack = 100U;
   const std::uint64_t ack_bits = (1ULL << 1U) | (1ULL << 2U);
 
-  static_cast<void>(handler.on_remote_ack(ack, ack_bits, tx));
-  ASSERT_NE(tx.inflight.find(100U), tx.inflight.end());
+  static_cast<void>(handler.on_remote_ack(ack, ack_bits, 0U, tx));
+  ASSERT_TRUE(tx.inflight.contains(100U));
   EXPECT_EQ(tx.inflight.at(100U).gap_evidence_count, 1U);
   EXPECT_FALSE(tx.inflight.at(100U).fast_retx_pending);
 
-  static_cast<void>(handler.on_remote_ack(ack, ack_bits, tx));
-  ASSERT_NE(tx.inflight.find(100U), tx.inflight.end());
+  static_cast<void>(handler.on_remote_ack(ack, ack_bits, 0U, tx));
+  ASSERT_TRUE(tx.inflight.contains(100U));
   EXPECT_EQ(tx.inflight.at(100U).gap_evidence_count, 2U);
   EXPECT_TRUE(tx.inflight.at(100U).fast_retx_pending);
 
@@ -140,7 +142,7 @@ TEST(TxHandlerAckTest, RetransmissionStopsAfterFixedRetryLimit) {
                      connection_state, rx, tx);
     ASSERT_FALSE(result.fatal_error);
     ASSERT_TRUE(result.datagram.has_value());
-    ASSERT_NE(tx.inflight.find(200U), tx.inflight.end());
+    ASSERT_TRUE(tx.inflight.contains(200U));
     EXPECT_EQ(tx.inflight.at(200U).retry_count, i + 1U);
   }
 
@@ -151,7 +153,41 @@ TEST(TxHandlerAckTest, RetransmissionStopsAfterFixedRetryLimit) {
   EXPECT_FALSE(exhausted_result.datagram.has_value());
   EXPECT_EQ(exhausted_result.error_message,
             "retransmission retry limit exceeded");
-  EXPECT_EQ(tx.inflight.find(200U), tx.inflight.end());
+  EXPECT_FALSE(tx.inflight.contains(200U));
+}
+
+// Verifies only never-retransmitted packets produce RTT samples (Karn's rule)
+// and that the resulting SRTT + 4 * RTTVAR replaces the initial RTO.
+TEST(TxHandlerAckTest, AckedPacketsDriveRtoUnderKarnsRule) {
+  TxHandler handler;
+  TxSessionState tx;
+  RxSessionState rx;
+  ConnectionState connection_state = ConnectionState::Established;
+  seed_inflight(tx, {100U, 101U});
+  tx.inflight.at(100U).first_send_ms = 1'000U;
+  tx.inflight.at(100U).last_send_ms = 1'000U;
+  tx.inflight.at(101U).first_send_ms = 1'000U;
+  tx.inflight.at(101U).last_send_ms = 1'400U;
+  tx.inflight.at(101U).retry_count = 1U;
+
+  const auto first = handler.on_remote_ack(101U, 0ULL, 1'010U, tx);
+  EXPECT_EQ(first.rtt_sample_ms, std::optional<std::uint64_t>(10U));
+  EXPECT_EQ(tx.rtt.rto_ms, 30U);
+
+  const auto retransmitted = handler.on_remote_ack(102U, 0ULL, 1'500U, tx);
+  EXPECT_FALSE(retransmitted.rtt_sample_ms.has_value());
+  EXPECT_EQ(tx.rtt.rto_ms, 30U);
+
+  seed_inflight(tx, {102U});
+  tx.inflight.at(102U).last_send_ms = 2'000U;
+  EXPECT_FALSE(handler
+                   .poll(2'029U, SessionRole::Server, 1234U, connection_state,
+                         rx, tx)
+                   .datagram.has_value());
+  EXPECT_TRUE(handler
+                  .poll(2'030U, SessionRole::Server, 1234U, connection_state,
+                        rx, tx)
+                  .datagram.has_value());
 }
 
 TEST(TxHandlerAckTest, FinalHandshakeAckDoesNotEnterRetransmitInflight) {
@@ -174,4 +210,73 @@ TEST(TxHandlerAckTest, FinalHandshakeAckDoesNotEnterRetransmitInflight) {
   EXPECT_FALSE(later_result.datagram.has_value());
 }
 
+// Verifies poll results describe the datagram they carry, matching what a
+// decode of the bytes would report, for control, data and retransmitted
+// packets.
+TEST(TxHandlerAckTest, PollResultDescribesBuiltDatagram) {
+  TxHandler handler;
+  TxSessionState tx;
+  RxSessionState rx;
+  ConnectionState connection_state = ConnectionState::Established;
+  tx.probe.ping_pending = true;
+  const std::vector<std::byte> payload{std::byte{0x01}, std::byte{0x02}};
+  handler.queue_app_data(4U, Rudp::ChannelType::ReliableUnordered, payload, tx);
+
+  const auto ping =
+      handler.poll(0U, SessionRole::Client, 1234U, connection_state, rx, tx);
+  ASSERT_TRUE(ping.datagram.has_value());
+  EXPECT_EQ(ping.control_kind, ControlKind::Ping);
+  EXPECT_EQ(ping.payload_size, 0U);
+  EXPECT_EQ(ping.written, ping.datagram->size());
+
+  const auto data =
+      handler.poll(0U, SessionRole::Client, 1234U, connection_state, rx, tx);
+  ASSERT_TRUE(data.datagram.has_value());
+  const auto decoded = Rudp::Codec::decode(*data.datagram);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(data.control_kind, ControlKind::None);
+  EXPECT_EQ(data.header.seq, decoded->header.seq);
+  EXPECT_EQ(data.header.channel_id, 4U);
+  EXPECT_EQ(data.payload_size, decoded->payload.size());
+  EXPECT_FALSE(data.retransmission);
+
+  rx.next_expected = 9U;
+  const auto retransmit = handler.poll(
+      5'000U, SessionRole::Client, 1234U, connection_state, rx, tx);
+  ASSERT_TRUE(retransmit.datagram.has_value());
+  EXPECT_TRUE(retransmit.retransmission);
+  EXPECT_EQ(retransmit.header.seq, data.header.seq);
+  EXPECT_EQ(retransmit.header.ack, 9U);
+  EXPECT_EQ(retransmit.payload_size, payload.size());
+}
+
+// Verifies a payload handed over by move reaches the inflight entry without
+// being copied, and that its retransmission still carries the same bytes.
+TEST(TxHandlerAckTest, MovedPayloadIsKeptForRetransmissionWithoutCopy) {
+  TxHandler handler;
+  TxSessionState tx;
+  RxSessionState rx;
+  ConnectionState connection_state = ConnectionState::Established;
+  std::vector<std::byte> payload(1024U, std::byte{0x7e});
+  const auto* storage = payload.data();
+  handler.queue_app_data(2U, Rudp::ChannelType::ReliableOrdered,
+                         std::move(payload), tx);
+
+  const auto sent =
+      handler.poll(0U, SessionRole::Client, 55U, connection_state, rx, tx);
+  ASSERT_TRUE(sent.datagram.has_value());
+  const auto* entry = tx.inflight.find(sent.header.seq);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->packet.payload.data(), storage);
+
+  const auto retransmit =
+      handler.poll(5'000U, SessionRole::Client, 55U, connection_state, rx, tx);
+  ASSERT_TRUE(retransmit.datagram.has_value());
+  EXPECT_TRUE(retransmit.retransmission);
+  const auto decoded = Rudp::Codec::decode(*retransmit.datagram);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->payload.size(), 1024U);
+  EXPECT_EQ(decoded->payload.front(), std::byte{0x7e});
+}
+
 }  // namespace
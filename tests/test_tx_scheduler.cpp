@@ -0,0 +1,94 @@
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Rudp/Config.hpp"
+#include "Rudp/SessionTypes.hpp"
+#include "Rudp/TxHandler.hpp"
+
+namespace {
+
+using Rudp::Session::ConnectionState;
+using Rudp::Session::RxSessionState;
+using Rudp::Session::SessionRole;
+using Rudp::Session::TxHandler;
+using Rudp::Session::TxSessionState;
+
+// Channel id of the next fresh datagram, or nullopt when nothing was sent.
+std::optional<std::uint32_t> poll_channel(TxHandler& handler,
+                                          RxSessionState& rx,
+                                          TxSessionState& tx) {
+  auto connection_state = ConnectionState::Established;
+  const auto result = handler.poll(0U, SessionRole::Client, 3U,
+                                   connection_state, rx, tx);
+  if (!result.datagram.has_value()) {
+    return std::nullopt;
+  }
+  return result.header.channel_id;
+}
+
+// Verifies a bulk channel queued first does not starve the others: equal
+// priorities share datagrams by weight, and a better priority goes first.
+TEST(TxSchedulerTest, ChannelsShareTheLinkByPriorityAndWeight) {
+  auto& settings = Rudp::Config::mutable_current();
+  const auto previous = settings.transport;
+  settings.transport.max_datagram_bytes = 1200U;
+  settings.transport.channel_schedules = {
+      {.channel_id = 1U, .priority = 1U, .weight = 1U},
+      {.channel_id = 2U, .priority = 1U, .weight = 3U},
+      {.channel_id = 3U, .priority = 0U, .weight = 1U},
+  };
+
+  TxHandler handler;
+  TxSessionState tx;
+  RxSessionState rx;
+  const std::vector<std::byte> payload(600U, std::byte{0x5a});
+  for (int i = 0; i < 40; ++i) {
+    handler.queue_app_data(1U, Rudp::ChannelType::Unreliable, payload, tx);
+  }
+  for (int i = 0; i < 40; ++i) {
+    handler.queue_app_data(2U, Rudp::ChannelType::Unreliable, payload, tx);
+  }
+  handler.queue_app_data(3U, Rudp::ChannelType::Unreliable, payload, tx);
+
+  EXPECT_EQ(poll_channel(handler, rx, tx), std::optional<std::uint32_t>(3U));
+  std::map<std::uint32_t, std::size_t> sent;
+  for (int i = 0; i < 32; ++i) {
+    const auto channel = poll_channel(handler, rx, tx);
+    ASSERT_TRUE(channel.has_value());
+    ++sent[*channel];
+  }
+  EXPECT_EQ(sent[1U], 8U);
+  EXPECT_EQ(sent[2U], 24U);
+  EXPECT_EQ(tx.pending_send_count, 48U);
+
+  settings.transport = previous;
+}
+
+// Verifies a reliable queue stalled by a full send window no longer holds
+// back unreliable traffic queued after it.
+TEST(TxSchedulerTest, UnreliableDataPassesWindowBlockedReliableQueue) {
+  TxHandler handler;
+  TxSessionState tx;
+  RxSessionState rx;
+  tx.send_window = 1U;
+  const std::vector<std::byte> payload{std::byte{0x11}};
+  handler.queue_app_data(1U, Rudp::ChannelType::ReliableOrdered, payload, tx);
+  handler.queue_app_data(1U, Rudp::ChannelType::ReliableOrdered, payload, tx);
+  handler.queue_app_data(2U, Rudp::ChannelType::Unreliable, payload, tx);
+
+  EXPECT_EQ(poll_channel(handler, rx, tx), std::optional<std::uint32_t>(1U));
+  EXPECT_EQ(poll_channel(handler, rx, tx), std::optional<std::uint32_t>(2U));
+  EXPECT_EQ(poll_channel(handler, rx, tx), std::nullopt);
+  EXPECT_EQ(tx.pending_send_count, 1U);
+
+  static_cast<void>(handler.on_remote_ack(1U, 0U, 0U, tx));
+  EXPECT_EQ(poll_channel(handler, rx, tx), std::optional<std::uint32_t>(1U));
+  EXPECT_EQ(tx.pending_send_count, 0U);
+}
+
+}  // namespace